@@ -27,7 +27,8 @@ using namespace std;
 
 namespace car {
 
-    bool BfsChecker::try_satisfy (const int frame_level)
+    template <bool Forward>
+    bool BfsChecker<Forward>::try_satisfy (const int frame_level)
 	{
 				
 		int res = do_search (frame_level);
@@ -37,85 +38,87 @@ namespace car {
 		    return false;
 		
 		//for forward CAR, the initial states are set of cubes
-		State *s = enumerate_start_state ();
+		State *s = this->enumerate_start_state ();
 		while (s != NULL)
 		{
-		    if (!forward_) //for dot drawing
+		    if (!this->forward_) //for dot drawing
 			    s->set_initial (true);
 			
 			//////generate dot data
-			if (dot_ != NULL)
-			    (*dot_) << "\n\t\t\t" << s->id () << " [shape = circle, color = red, label = \"Init\", size = 0.1];";
+			if (this->dot_ != NULL)
+			    (*this->dot_) << "\n\t\t\t" << s->id () << " [shape = circle, color = red, label = \"Init\", size = 0.1];";
 			//////generate dot data
 			
 			s->set_depth (0);
-		    update_B_sequence (s);
+		    s = this->update_B_sequence (s);
 		    
 		    const_cast<State*> (s)->set_work_level (frame_level);
 		    
 			if (try_satisfy_by (frame_level, s))
 			    return true;
-			if (safe_reported ())
+			if (this->safe_reported ())
 				return false;
-		    s = enumerate_start_state ();
+		    s = this->enumerate_start_state ();
 		}
 	
 		return false;
 	}
 
-    int BfsChecker::do_search (const int frame_level) {
-        for (int i = B_.size () - 1; i >= 0; i --){
-	        for (int j = 0; j < B_[i].size (); j ++){
-			    if (try_satisfy_by (B_[i][j]->work_level (), B_[i][j]))
+    template <bool Forward>
+    int BfsChecker<Forward>::do_search (const int frame_level) {
+        for (int i = this->B_.size () - 1; i >= 0; i --){
+	        for (int j = 0; j < this->B_[i].size (); j ++){
+			    if (try_satisfy_by (this->B_[i][j]->work_level (), this->B_[i][j]))
 			        return 1;
-				if (safe_reported ())
+				if (this->safe_reported ())
 				    return 0;
 			    }
 		    }
 		return -1;
     }
 
-    bool BfsChecker::try_satisfy_by (int frame_level, const State* s) {
-        if (tried_before (s, frame_level+1)) {
+    template <bool Forward>
+    bool BfsChecker<Forward>::try_satisfy_by (int frame_level, const State* s) {
+        if (this->tried_before (s, frame_level+1)) {
             const_cast<State*> (s)->set_work_level (frame_level+1);
 			return false;
 	    }
 		
-		if (frame_level < minimal_update_level_)
-			minimal_update_level_ = frame_level;
+		if (frame_level < this->minimal_update_level_)
+			this->minimal_update_level_ = frame_level;
 		
 		
 		if (frame_level == -1)
 		{
-		    if (immediate_satisfiable (s))
+		    if (this->immediate_satisfiable (s))
 		        return true;
 		}
 		else
 		{
 		    
-		    while (solve_with (const_cast<State*>(s)->s (), frame_level))
+		    while (this->solve_with (const_cast<State*>(s)->s (), frame_level))
 		    {
-			    State* new_state = get_new_state (s);
+			    State* new_state = this->get_new_state (s);
 			    assert (new_state != NULL);
 			    
 			    //////generate dot data
-			    if (dot_ != NULL)
-			        (*dot_) << "\n\t\t\t" << const_cast<State*> (s)->id () << " -- " << new_state->id ();
+			    if (this->dot_ != NULL)
+			        (*this->dot_) << "\n\t\t\t" << const_cast<State*> (s)->id () << " -- " << new_state->id ();
 			    //////generate dot data
 			    
-			    int new_level = get_new_level (new_state, frame_level);
+			    int new_level = this->get_new_level (new_state, frame_level);
 
-			    update_B_sequence (new_state);
+			    new_state = this->update_B_sequence (new_state);
 			    
 			    new_state -> set_work_level (new_level);
 			    
 			    if (try_satisfy_by (new_level, new_state))
 				    return true;
-				if (safe_reported ())
+				if (this->safe_reported ())
 				    return false;
 				if (frame_level < s->work_level ())
 				{ 
-				    while (tried_before (s, frame_level+1))
+				    while (this->tried_before (s, frame_level+1))
 				    {
 				        frame_level = frame_level + 1;
 					    if (frame_level >= s->work_level ()) {
@@ -127,8 +130,8 @@ namespace car {
 		    }
 		}
 
-		update_F_sequence (s, frame_level+1);
-		if (safe_reported ())
+		this->update_F_sequence (s, frame_level+1);
+		if (this->safe_reported ())
 			return false;
 		
 		const_cast<State*> (s)->set_work_level (frame_level+1);
@@ -136,5 +139,7 @@ namespace car {
 		return false;
     }
     
+    template class BfsChecker<true>;
+    template class BfsChecker<false>;
 }
 
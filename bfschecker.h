@@ -28,9 +28,10 @@
  
  namespace car {
  
-    class BfsChecker: public Checker {
+    template <bool Forward>
+    class BfsChecker: public CarEngine<Forward> {
         public:
-            BfsChecker (Model* model, Statistics& stats, std::ofstream* dot, bool forward = true, bool evidence = false, bool verbose = false, bool minimal_uc = false) : Checker (model, stats, dot, forward, evidence, verbose, minimal_uc) {}
+            BfsChecker (Model* model, Statistics& stats, std::ofstream* dot, bool evidence = false, bool verbose = false, bool minimal_uc = false) : CarEngine<Forward> (model, stats, dot, evidence, verbose, minimal_uc) {}
         protected:
             bool try_satisfy (const int frame_level);
             int do_search (const int frame_level);
@@ -0,0 +1,183 @@
+/*
+    Copyright (C) 2018, Jianwen Li (lijwen2748@gmail.com), Iowa State University
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+	Author: Jianwen Li
+	Update Date: October 19, 2026
+	Word-parallel random simulation over the and gates of the model
+*/
+
+#include "bitsim.h"
+#include <assert.h>
+using namespace std;
+
+namespace car
+{
+	BitSim::BitSim (Model* m, const uint64_t seed)
+	{
+		model_ = m;
+		seed_ = seed;
+		values_.resize ((m->max_id () + 1) * SIM_WORDS, 0);
+		nexts_.resize (m->num_latches () * SIM_WORDS, 0);
+		Word* t = word (m->true_id ());
+		for (int w = 0; w < SIM_WORDS; w ++)
+			t[w] = ~Word (0);
+		reseed (0);
+	}
+
+	void BitSim::reset ()
+	{
+		int start = model_->num_inputs () + 1;
+		for (int i = start; i < start + model_->num_latches (); i ++)
+		{
+			Word* l = word (i);
+			for (int w = 0; w < SIM_WORDS; w ++)
+				l[w] = 0;
+		}
+		Cube& init = model_->init ();
+		for (int i = 0; i < init.size (); i ++)
+		{
+			Word* l = word (abs (init[i]));
+			for (int w = 0; w < SIM_WORDS; w ++)
+				l[w] = init[i] > 0 ? ~Word (0) : 0;
+		}
+	}
+
+	void BitSim::random_inputs ()
+	{
+		for (int i = 1; i <= model_->num_inputs (); i ++)
+		{
+			Word* in = word (i);
+			for (int w = 0; w < SIM_WORDS; w ++)
+				in[w] = random ();
+		}
+	}
+
+	void BitSim::simulate ()
+	{
+		vector<Gate>& gates = model_->gates ();
+		for (int i = 0; i < gates.size (); i ++)
+		{
+			const Gate& g = gates[i];
+			Word* l = word (g.lhs);
+			const Word* a = word (abs (g.rhs0));
+			const Word* b = word (abs (g.rhs1));
+			Word ma = g.rhs0 < 0 ? ~Word (0) : 0;
+			Word mb = g.rhs1 < 0 ? ~Word (0) : 0;
+			//fixed trip count, so the loop is vectorized
+			for (int w = 0; w < SIM_WORDS; w ++)
+				l[w] = (a[w] ^ ma) & (b[w] ^ mb);
+		}
+	}
+
+	void BitSim::step ()
+	{
+		int start = model_->num_inputs () + 1;
+		for (int i = 0; i < model_->num_latches (); i ++)
+		{
+			int p = model_->prime (start + i);
+			const Word* v = word (abs (p));
+			Word m = p < 0 ? ~Word (0) : 0;
+			for (int w = 0; w < SIM_WORDS; w ++)
+				nexts_[i * SIM_WORDS + w] = v[w] ^ m;
+		}
+		for (int i = 0; i < model_->num_latches (); i ++)
+		{
+			Word* l = word (start + i);
+			for (int w = 0; w < SIM_WORDS; w ++)
+				l[w] = nexts_[i * SIM_WORDS + w];
+		}
+	}
+
+	void BitSim::and_into (Word* mask, const int lit)
+	{
+		const Word* v = word (abs (lit));
+		Word m = lit < 0 ? ~Word (0) : 0;
+		for (int w = 0; w < SIM_WORDS; w ++)
+			mask[w] &= v[w] ^ m;
+	}
+
+	bool BitSim::random_check (const int bad, vector<Assignment>& trace, const int cycles, const int rounds)
+	{
+		vector<int>& constraints = model_->constraints ();
+		for (int r = 0; r < rounds; r ++)
+		{
+			reseed (r);
+			reset ();
+			//the patterns which have satisfied the constraints so far
+			Word valid[SIM_WORDS];
+			for (int w = 0; w < SIM_WORDS; w ++)
+				valid[w] = ~Word (0);
+			for (int c = 0; c < cycles; c ++)
+			{
+				random_inputs ();
+				simulate ();
+				for (int i = 0; i < constraints.size (); i ++)
+					and_into (valid, constraints[i]);
+				Word hit[SIM_WORDS];
+				for (int w = 0; w < SIM_WORDS; w ++)
+					hit[w] = valid[w];
+				and_into (hit, bad);
+				for (int w = 0; w < SIM_WORDS; w ++)
+				{
+					if (hit[w] == 0)
+						continue;
+					int pattern = w * 64 + __builtin_ctzll (hit[w]);
+					get_trace (r, c, pattern, trace);
+					return true;
+				}
+				step ();
+			}
+		}
+		return false;
+	}
+
+	void BitSim::start_sampling ()
+	{
+		reseed (0);
+		reset ();
+		for (int w = 0; w < SIM_WORDS; w ++)
+			valid_[w] = ~Word (0);
+	}
+	
+	void BitSim::sample (vector<Word>& res)
+	{
+		random_inputs ();
+		simulate ();
+		vector<int>& constraints = model_->constraints ();
+		for (int i = 0; i < constraints.size (); i ++)
+			and_into (valid_, constraints[i]);
+		res.insert (res.end (), valid_, valid_ + SIM_WORDS);
+		int start = model_->num_inputs () + 1;
+		res.insert (res.end (), word (start), word (start + model_->num_latches ()));
+		step ();
+	}
+
+	void BitSim::get_trace (const int round, const int cycle, const int pattern, vector<Assignment>& trace)
+	{
+		trace.clear ();
+		reseed (round);
+		for (int c = 0; c <= cycle; c ++)
+		{
+			random_inputs ();
+			Assignment inputs;
+			for (int i = 1; i <= model_->num_inputs (); i ++)
+				inputs.push_back (bit (i, pattern) ? i : -i);
+			trace.push_back (inputs);
+		}
+	}
+}
@@ -0,0 +1,99 @@
+/*
+    Copyright (C) 2018, Jianwen Li (lijwen2748@gmail.com), Iowa State University
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+	Author: Jianwen Li
+	Update Date: October 19, 2026
+	Word-parallel random simulation over the and gates of the model
+*/
+
+#ifndef BIT_SIM_H
+#define BIT_SIM_H
+
+#include "model.h"
+#include "data_structure.h"
+#include <vector>
+#include <stdint.h>
+
+#define SIM_WORDS 4      //words per variable, i.e. 256 patterns, which the compiler may pack into one AVX2 register
+#define SIM_CYCLES 64    //cycles of one random simulation round
+#define SIM_ROUNDS 16    //rounds of random simulation, each from the initial state
+
+namespace car
+{
+	class BitSim
+	{
+	public:
+		typedef uint64_t Word;
+		static const int PATTERNS = SIM_WORDS * 64;
+
+		BitSim (Model* m, const uint64_t seed = 1);
+		~BitSim () {}
+
+		//set all patterns to the initial state, latches without an initial value are 0
+		void reset ();
+		//assign random values to the inputs
+		void random_inputs ();
+		//evaluate the and gates in topological order
+		void simulate ();
+		//move the latches to their next values
+		void step ();
+
+		inline bool bit (const int id, const int pattern) {
+			Word w = values_[abs (id) * SIM_WORDS + pattern / 64] >> (pattern % 64) & 1;
+			return id > 0 ? w : !w;
+		}
+
+		//Simulate random patterns from the initial state for at most \@ cycles cycles in each of \@ rounds rounds.
+		//Return true if \@ bad is hit under the constraints, with the inputs of each cycle up to the hit in \@ trace.
+		bool random_check (const int bad, std::vector<Assignment>& trace, const int cycles = SIM_CYCLES, const int rounds = SIM_ROUNDS);
+		
+		//start a random run from the initial state for sample ()
+		void start_sampling ();
+		//Append SIM_WORDS words marking the patterns which meet the constraints so far, followed by
+		//SIM_WORDS words for each latch, i.e. the states of the current cycle, to \@ res. Then go to the next cycle.
+		void sample (std::vector<Word>& res);
+
+	private:
+		Model* model_;
+		std::vector<Word> values_;  //SIM_WORDS words for each model id
+		std::vector<Word> nexts_;   //buffer of the next latch values
+		uint64_t seed_;
+		uint64_t rng_;
+		Word valid_[SIM_WORDS];     //the patterns of the sampling run which meet the constraints
+
+		inline Word* word (const int id) {return &values_[id * SIM_WORDS];}
+
+		//start the random sequence of round \@ round, the odd multiplier keeps it nonzero
+		inline void reseed (const int round) {rng_ = (seed_ + round) * 0x9E3779B97F4A7C15ULL;}
+
+		inline uint64_t random () {
+			//xorshift64*
+			rng_ ^= rng_ >> 12;
+			rng_ ^= rng_ << 25;
+			rng_ ^= rng_ >> 27;
+			return rng_ * 2685821657736338717ULL;
+		}
+
+		//AND of \@ lit over all patterns into \@ mask
+		void and_into (Word* mask, const int lit);
+		//replay round \@ round up to \@ cycle and collect the inputs of \@ pattern
+		void get_trace (const int round, const int cycle, const int pattern, std::vector<Assignment>& trace);
+	};
+}
+
+#endif
@@ -51,6 +51,8 @@ namespace car
  	}
  	
  	bool CARSolver::solve_assumption () {
+ 		if (pool_ != NULL)
+ 			import_learnts ();
  		for (int i = 0; i < assumption_.size (); i ++) {
  			picosat_assume (picosat_, assumption_[i]);
  		}
@@ -58,6 +60,20 @@ namespace car
         return res == PICOSAT_SATISFIABLE;
  	}
  	
+ 	int CARSolver::solve_assumption (const int limit) {
+ 		if (pool_ != NULL)
+ 			import_learnts ();
+ 		for (int i = 0; i < assumption_.size (); i ++) {
+ 			picosat_assume (picosat_, assumption_[i]);
+ 		}
+ 	    int res = picosat_sat(picosat_, limit);
+ 	    if (res == PICOSAT_SATISFIABLE)
+ 	    	return 1;
+ 	    else if (res == PICOSAT_UNSATISFIABLE)
+ 	    	return 0;
+ 	    return -1;
+ 	}
+ 	
  	//return the model from SAT solver when it provides SAT
 	std::vector<int> CARSolver::get_model () {
 	    vector<int> res;
@@ -93,14 +109,22 @@ namespace car
     	return reason;
   	}
 	
-	void CARSolver::add_clause (std::vector<int>& v) {
-	    for (int i = 0; i < v.size(); i ++) {
-            picosat_add(picosat_, v[i]);
+	void CARSolver::add_clause (const int* lits, const int size) {
+	    if (lazy_) {
+	        for (int i = 0; i < size; i ++)
+	            load (lits[i]);
+	    }
+	    for (int i = 0; i < size; i ++) {
+            picosat_add(picosat_, lits[i]);
         }
         picosat_add(picosat_, 0);
  		
  	}
  	
+ 	void CARSolver::set_phase (int id) {
+ 	    picosat_set_default_phase_lit (picosat_, SAT_lit (id), 1);
+ 	}
+ 	
  	#else
  	
  	Lit CARSolver::SAT_lit (int id)
@@ -121,6 +145,8 @@ namespace car
  	
  	bool CARSolver::solve_assumption ()
 	{
+		if (pool_ != NULL)
+			import_learnts ();
 		lbool ret = solveLimited (assumption_);
 		/*
 		if (verbose_)
@@ -138,6 +164,20 @@ namespace car
    		return false;
 	}
 	
+	int CARSolver::solve_assumption (const int limit)
+	{
+		if (pool_ != NULL)
+			import_learnts ();
+		setConfBudget (limit);
+		lbool ret = solveLimited (assumption_);
+		budgetOff ();
+		if (ret == l_True)
+			return 1;
+		else if (ret == l_False)
+			return 0;
+		return -1;
+	}
+	
 	//return the model from SAT solver when it provides SAT
 	std::vector<int> CARSolver::get_model ()
 	{
@@ -259,11 +299,18 @@ namespace car
 		return reason;
   	}
 	
-	void CARSolver::add_clause (std::vector<int>& v)
+	void CARSolver::add_clause (const int* ids, const int size)
  	{
- 		vec<Lit> lits;
- 		for (std::vector<int>::iterator it = v.begin (); it != v.end (); it ++)
- 			lits.push (SAT_lit (*it));
+ 		if (lazy_)
+ 		{
+ 			for (int i = 0; i < size; i ++)
+ 				load (ids[i]);
+ 		}
+ 		//addClause_ works on the buffer in place, so it is refilled for each clause without allocation
+ 		vec<Lit>& lits = add_buffer_;
+ 		lits.clear ();
+ 		for (int i = 0; i < size; i ++)
+ 			lits.push (SAT_lit (ids[i]));
  		/*
  		if (verbose_)
  		{
@@ -274,47 +321,92 @@ namespace car
  			cout << "Before adding, size of clauses is " << clauses.size () << endl;
  		}
  		*/
- 		bool res = addClause (lits);
+ 		bool res = addClause_ (lits);
  		
  		if (!res && verbose_)
  			cout << "Warning: Adding clause does not success\n";
  		
  	}
  	
+ 	void CARSolver::learntCallback (const vec<Lit>& c, int lbd)
+ 	{
+ 		if (!pool_->accept (c.size (), lbd))
+ 			return;
+ 		std::vector<int> cl;
+ 		for (int i = 0; i < c.size (); i ++)
+ 			cl.push_back (lit_id (c[i]));
+ 		pool_->add (cl, pool_id_);
+ 	}
+ 	
+ 	void CARSolver::set_phase (int id)
+ 	{
+ 		Lit l = SAT_lit (id);
+ 		//minisat stores the sign of the preferred literal, i.e. true means negative
+ 		setPolarity (var (l), sign (l));
+ 	}
+ 	
  	#endif
  	
+ 	void CARSolver::add_clause (std::vector<int>& v)
+ 	{
+ 		add_clause (v.data (), v.size ());
+ 	}
+ 	
  	void CARSolver::add_clause (int id)
  	{
- 		std::vector<int> v;
- 		v.push_back (id);
- 		add_clause (v);
+ 		add_clause (&id, 1);
  	}
  	
  	void CARSolver::add_clause (int id1, int id2)
  	{
- 		std::vector<int> v;
- 		v.push_back (id1);
- 		v.push_back (id2);
- 		add_clause (v);
+ 		int v[2] = {id1, id2};
+ 		add_clause (v, 2);
  	}
  	
  	void CARSolver::add_clause (int id1, int id2, int id3)
  	{
- 		std::vector<int> v;
- 		v.push_back (id1);
- 		v.push_back (id2);
- 		v.push_back (id3);
- 		add_clause (v);
+ 		int v[3] = {id1, id2, id3};
+ 		add_clause (v, 3);
  	}
  	
  	void CARSolver::add_clause (int id1, int id2, int id3, int id4)
  	{
- 		std::vector<int> v;
- 		v.push_back (id1);
- 		v.push_back (id2);
- 		v.push_back (id3);
- 		v.push_back (id4);
- 		add_clause (v);
+ 		int v[4] = {id1, id2, id3, id4};
+ 		add_clause (v, 4);
+ 	}
+ 	
+ 	void CARSolver::add_clauses (const ClauseArena& arena, const int begin, const int end)
+ 	{
+ 		const int* lits = arena.lits ();
+ 		const int* offsets = arena.offsets ();
+ 		for (int i = begin; i < end; i ++)
+ 			add_clause (lits + offsets[i], offsets[i+1] - offsets[i]);
+ 	}
+ 	
+ 	void CARSolver::set_phases (const std::vector<int>& ids)
+ 	{
+ 	    for (int i = 0; i < ids.size (); i ++)
+ 	        set_phase (ids[i]);
+ 	}
+ 	
+ 	void CARSolver::set_learnt_pool (LearntPool* pool, const bool exporting)
+ 	{
+ 	    pool_ = pool;
+ 	    pool_id_ = pool->register_solver ();
+ 	    #ifndef ENABLE_PICOSAT
+ 	    export_learnts = exporting;
+ 	    #else
+ 	    //picosat does not report its learnt clauses, and main () rejects -share in this build
+ 	    assert (!exporting);
+ 	    #endif
+ 	}
+ 	
+ 	void CARSolver::import_learnts ()
+ 	{
+ 	    std::vector<std::vector<int> > cls;
+ 	    pool_->fetch (pool_id_, cls);
+ 	    for (int i = 0; i < cls.size (); i ++)
+ 	        add_clause (cls[i]);
  	}
  	
  	void CARSolver::add_cube (const std::vector<int>& cu)
@@ -35,6 +35,8 @@ extern "C" {
 #endif
 
 #include "statistics.h"  //zhang xiaoyu made this change
+#include "learntpool.h"
+#include "clausearena.h"
 #include <vector>
 #include <assert.h>
 #include <fstream>      //zhang xiaou add this code
@@ -49,11 +51,11 @@ namespace car
 	{
 	public:
 	    #ifdef ENABLE_PICOSAT
-	    CARSolver () { picosat_ = picosat_init(); }
-		CARSolver (bool verbose) : verbose_ (verbose) { picosat_reset(picosat_); } 
+	    CARSolver () : pool_ (NULL), lazy_ (false) { picosat_ = picosat_init(); }
+		CARSolver (bool verbose) : verbose_ (verbose), pool_ (NULL), lazy_ (false) { picosat_reset(picosat_); } 
 	    #else
-		CARSolver () {}
-		CARSolver (bool verbose) : verbose_ (verbose) {} 
+		CARSolver () : pool_ (NULL), lazy_ (false) {}
+		CARSolver (bool verbose) : verbose_ (verbose), pool_ (NULL), lazy_ (false) {} 
 		#endif
 		
 		bool verbose_;
@@ -67,6 +69,8 @@ namespace car
 		Statistics* stats_;   //zhang xiaoyu made this change
 		//functions
 		bool solve_assumption ();
+		//solve within a budget of \@ limit conflicts (decisions for PicoSat): 1 for SAT, 0 for UNSAT, -1 if it runs out
+		int solve_assumption (const int limit);
 		std::vector<int> get_model ();    //get the model from SAT solver
  		std::vector<int> get_uc ();       //get UC from SAT solver
 		//zhang xiaoyu code begins
@@ -83,6 +87,18 @@ namespace car
  		void add_clause (int, int, int);
  		void add_clause (int, int, int, int);
  		void add_clause (std::vector<int>&);
+ 		void add_clause (const int* ids, const int size);
+ 		//bulk load of clauses [\@ begin, \@ end) of \@ arena
+ 		void add_clauses (const ClauseArena& arena, const int begin, const int end);
+ 		
+ 		//phase hints: make the next decisions on the variable of \@ id prefer the polarity of \@ id
+ 		void set_phase (int id);
+ 		void set_phases (const std::vector<int>& ids);
+ 		
+ 		//learnt clause sharing: clauses of \@ pool exported by other solvers are added before each solving,
+ 		//and if \@ exporting is true the short learnt clauses of this solver go to \@ pool
+ 		void set_learnt_pool (LearntPool* pool, const bool exporting);
+ 		void import_learnts ();
  	
  	    #ifdef ENABLE_PICOSAT
  	    int SAT_lit (int id); //create the Lit used in PicoSat SAT solver for the id.
@@ -99,6 +115,8 @@ namespace car
  		inline void clear_assumption () {assumption_.clear ();}
  		
  		inline void assumption_push (int id) {
+ 			if (lazy_)
+ 				load (id);
  			#ifdef ENABLE_PICOSAT
  			assumption_.push_back (id);
  			#else
@@ -141,9 +159,20 @@ namespace car
  			add_clause (-l, r3);
  			add_clause (l, -r1, -r2, -r3);
  		}
+ 	protected:
+ 		LearntPool* pool_;
+ 		int pool_id_;
+ 		
+ 		//lazy clause loading: with \@ lazy_, load () is called on each literal of the assumptions and
+ 		//the clauses before they reach the SAT solver, to add the clauses it depends on first
+ 		bool lazy_;
+ 		virtual void load (const int id) {}
  	#ifdef ENABLE_PICOSAT
  	private:
  	   PicoSAT* picosat_;
+ 	#else
+ 		void learntCallback (const Minisat::vec<Minisat::Lit>& c, int lbd);
+ 		Minisat::vec<Minisat::Lit> add_buffer_;  //literals of the clause being added
  	#endif
 	};
 }
@@ -23,6 +23,8 @@
 #include "checker.h"
 #include <vector>
 #include <iostream>
+#include <thread>
+#include <atomic>
 #include "utility.h"
 #include "statistics.h"
 using namespace std;
@@ -30,18 +32,20 @@ using namespace std;
 namespace car
 {
     ///////////////////////////////////main functions//////////////////////////////////
-    bool Checker::check (std::ofstream& out){
+    template <bool Forward>
+    bool CarEngine<Forward>::check (std::ofstream& out){
 	    for (int i = 0; i < model_->num_outputs (); i ++){
 	        if(ilock_)	bad_ = - model_->output (i);
 			else bad_ = model_->output (i);
 	        
 	        //for the particular case when bad_ is true or false
-	        if (bad_ == model_->true_id ()){
+	        //with constraints, a true output is only reached if they hold in some initial state
+	        if (bad_ == model_->true_id () && model_->constraints ().empty ()){
 	        	out << "1" << endl;
-	        	out << "b" << i << endl;
+	        	out << "b" << output_base_ + i << endl;
 	        	if (evidence_){
 	        	    //print init state
-	        	    out << init_->latches() << endl;
+	        	    out << init_line () << endl;
 	        	    //print an arbitary input vector
 	        	    for (int j = 0; j < model_->num_inputs (); j ++)
 	        	        out << "0";
@@ -51,16 +55,27 @@ namespace car
 	        	if (verbose_){
 	        		cout << "return SAT since the output is true" << endl;
 	        	}
-	        	return true;
+	        	if (i == model_->num_outputs () - 1)
+	        		return true;
+	        	continue;
 	        }
 	        else if (bad_ == model_->false_id ()){
 	        	out << "0" << endl;
-	        	out << "b" << endl;
+	        	out << "b" << output_base_ + i << endl;
 	        	out << "." << endl;
 	        	if (verbose_){
 	        		cout << "return UNSAT since the output is false" << endl;
 	        	}
-	        	return false;
+	        	if (i == model_->num_outputs () - 1)
+	        		return false;
+	        	continue;
+	        }
+	        
+	        //shallow counterexamples are often hit by simulation, before any solver is built
+	        if (random_sim_ && random_check (out, i)){
+	        	if (i == model_->num_outputs () - 1)
+	        		return true;
+	        	continue;
 	        }
 	        
 	        car_initialization ();
@@ -69,7 +84,7 @@ namespace car
     			out << "1" << endl;
    			else
     			out << "0" << endl;
-    		out << "b" << i << endl;
+    		out << "b" << output_base_ + i << endl;
    			if (evidence_ && res)
     			print_evidence (out);
     		out << "." << endl;
@@ -80,7 +95,31 @@ namespace car
 	    }
 	}
 	
-	bool Checker::car_check (){
+	template <bool Forward>
+	bool CarEngine<Forward>::random_check (std::ofstream& out, const int output){
+		BitSim sim (model_);
+		vector<Assignment> trace;
+		if (!sim.random_check (bad_, trace))
+			return false;
+		
+		out << "1" << endl;
+		out << "b" << output_base_ + output << endl;
+		if (evidence_){
+			out << init_line () << endl;
+			for (int i = 0; i < trace.size (); i ++){
+				for (int j = 0; j < trace[i].size (); j ++)
+					out << (trace[i][j] > 0 ? "1" : "0");
+				out << endl;
+			}
+		}
+		out << "." << endl;
+		if (verbose_)
+			cout << "return SAT from random simulation at depth " << trace.size () - 1 << endl;
+		return true;
+	}
+	
+	template <bool Forward>
+	bool CarEngine<Forward>::car_check (){
 		if (verbose_)
 			cout << "start check ..." << endl;
 		if (immediate_satisfiable ()){
@@ -147,7 +186,8 @@ namespace car
 		return false;
 	}
 	
-	bool Checker::try_satisfy (const int frame_level)
+	template <bool Forward>
+	bool CarEngine<Forward>::try_satisfy (const int frame_level)
 	{
 		
 		int res = do_search (frame_level);
@@ -170,7 +210,7 @@ namespace car
 			//////generate dot data
 			
 			s->set_depth (0);
-		    update_B_sequence (s);
+		    s = update_B_sequence (s);
 			if (try_satisfy_by (frame_level, s))
 			    return true;
 			if (safe_reported ())
@@ -189,19 +229,24 @@ namespace car
 	*       0: The safe result is reported
 	*       -1: else
 	*/
-	int Checker::do_search (const int frame_level) {	
-		//erase dead states
+	template <bool Forward>
+	int CarEngine<Forward>::do_search (const int frame_level) {	
+		//erase dead states, which are left in B_ as tombstones until here
 		for (int i = B_.size()-1; i >= 0; --i){
+			int k = 0;
 			for (int j = 0; j < B_[i].size(); ++j){
 				if (B_[i][j]->is_dead()){
-					State* s = B_[i][j];
-					B_[i].erase (B_[i].begin()+j);
-					delete s;
-					j --;
+					remove_from_state_index (B_[i][j]);
+					delete B_[i][j];
 				}
+				else
+					B_[i][k++] = B_[i][j];
 			}
+			B_[i].resize (k);
 		}
 		//end of erase
+		if (max_state_bytes_ > 0)
+			evict_states ();
 		
 		if (begin_) {
 			vector<State*> states;
@@ -231,8 +276,11 @@ namespace car
 		return -1;
 	}
 	
-	bool Checker::try_satisfy_by (int frame_level, State* s)
+	template <bool Forward>
+	bool CarEngine<Forward>::try_satisfy_by (int frame_level, State* s)
 	{
+		s->set_last_try (++try_counter_);
+		s->update_try_level (frame_level);
 		if (tried_before (s, frame_level+1))
 			return false;
 		
@@ -252,6 +300,9 @@ namespace car
 		    {
 			    State* new_state = get_new_state (s);
 			    assert (new_state != NULL);
+			    new_state = update_B_sequence (new_state);
+			    if (phase_)
+			    	save_phase_model (new_state, frame_level);
 			    /*
 			    cout << "frame " << frame_level << ":" << endl;
 			    cout << "s: " << endl;
@@ -267,8 +318,6 @@ namespace car
 			    //////generate dot data
 			    
 			    int new_level = get_new_level (new_state, frame_level);
-
-			    update_B_sequence (new_state);
 			    
 			    if (try_satisfy_by (new_level, new_state))
 				    return true;
@@ -325,7 +374,8 @@ namespace car
 	}
 	
 	/*************propagation****************/
-	bool Checker::propagate (){
+	template <bool Forward>
+	bool CarEngine<Forward>::propagate (){
 		int start = forward_ ? (minimal_update_level_ == 0 ? 1 : minimal_update_level_) : minimal_update_level_;
 		for (int i = (start); i < F_.size(); ++i)
 			if (propagate (i))
@@ -333,31 +383,62 @@ namespace car
 		return false;
 	}
 	
-	bool Checker::propagate (int n){
+	template <bool Forward>
+	bool CarEngine<Forward>::propagate (int n){
 		assert (n >= 0 && n < F_.size());
 		Frame& frame = F_[n];
 		Frame& next_frame = (n+1 >= F_.size()) ? frame_ : F_[n+1];
+		//F_[n] does not change while its cubes are pushed, so the witnesses only hold for it
+		push_witnesses_.clear ();
 		
 		bool flag = true;
+		std::vector<int> ids;
 		for (int i = 0; i < frame.size (); ++i){
-			Cube& cu = frame[i];
-			
-			
-			bool propagated = false;
-			for (int j = 0; j < next_frame.size(); ++j){
-				if (car::imply (cu, next_frame[j]) && car::imply (next_frame[j], cu)){
-					propagated = true;
-					break;
-				}
-			}
-			if (propagated) continue;
-			
-	
-		    if (propagate (cu, n)){
-		    	push_to_frame (cu, n+1);
+			int id = frame[i];
+			//equal cubes share the id
+			if (std::find (next_frame.begin (), next_frame.end (), id) != next_frame.end ())
+				continue;
+			if (propagate_threads_ > 1)
+				ids.push_back (id);
+			else{
+				const Cube& cu = CubeTable::cube (id);
+		    	if (sample_ && refuted_by_samples (cu, n))
+		    		flag = false;
+		    	else if (propagate (cu, n)){
+		    		push_to_frame (id, n+1);
+		    	}
+		    	else
+		    		flag = false;
 		    }
-		    else
-		    	flag = false;
+		}
+		
+		if (propagate_threads_ > 1){
+			//the pushes from F_[n] only change F_[n+1], so they are checked together and merged in order
+			std::vector<char> pushed (ids.size (), 0);
+			std::vector<int> todo;
+			for (int i = 0; i < ids.size (); ++i){
+				if (!(sample_ && refuted_by_samples (CubeTable::cube (ids[i]), n)))
+					todo.push_back (i);
+			}
+			if (todo.size () < PROPAGATE_MIN_CUBES){
+				for (int i = 0; i < todo.size (); ++i)
+					pushed[todo[i]] = propagate (CubeTable::cube (ids[todo[i]]), n);
+			}
+			else{
+				std::vector<int> todo_ids;
+				std::vector<char> todo_pushed;
+				for (int i = 0; i < todo.size (); ++i)
+					todo_ids.push_back (ids[todo[i]]);
+				propagate_in_parallel (todo_ids, n, todo_pushed);
+				for (int i = 0; i < todo.size (); ++i)
+					pushed[todo[i]] = todo_pushed[i];
+			}
+			for (int i = 0; i < ids.size (); ++i){
+				if (pushed[i])
+					push_to_frame (ids[i], n+1);
+				else
+					flag = false;
+			}
 		}
 		
 		if (flag)
@@ -365,7 +446,54 @@ namespace car
 		return false;
 	}
 	
-	bool Checker::propagate (Cube& cu, int n){
+	//load the cubes of F_[0..n] that push_solvers_[i] does not have yet
+	template <bool Forward>
+	void CarEngine<Forward>::sync_push_solver (const int i, const int n){
+		std::vector<std::unordered_set<int> >& loaded = push_loaded_[i];
+		while (loaded.size () <= n)
+			loaded.push_back (std::unordered_set<int> ());
+		for (int j = 0; j <= n; ++j){
+			for (int k = 0; k < F_[j].size (); ++k){
+				if (loaded[j].insert (F_[j][k]).second)
+					push_solvers_[i]->add_clause_from_cube (CubeTable::cube (F_[j][k]), j, forward_);
+			}
+		}
+	}
+	
+	//Check whether each cube of \@ ids can be pushed from F_[n] on its own solver, without the dead cubes
+	//and the learnt clauses of solver_, which only makes some pushes fail.
+	template <bool Forward>
+	void CarEngine<Forward>::propagate_in_parallel (const std::vector<int>& ids, const int n, std::vector<char>& pushed){
+		int num_threads = propagate_threads_;
+		if (num_threads > int (ids.size ()))
+			num_threads = ids.size ();
+		while (push_solvers_.size () < num_threads){
+			push_solvers_.push_back (new MainSolver (model_, stats_, false, bad_));
+			push_loaded_.push_back (std::vector<std::unordered_set<int> > ());
+		}
+		for (int i = 0; i < num_threads; ++i)
+			sync_push_solver (i, n);
+		
+		pushed.assign (ids.size (), 0);
+		std::vector<std::thread> threads;
+		stats_->count_main_solver_SAT_time_start ();
+		for (int i = 0; i < num_threads; ++i){
+			threads.push_back (std::thread ([&, i] () {
+				MainSolver* solver = push_solvers_[i];
+				for (int j = i; j < ids.size (); j += num_threads){
+					solver->set_assumption (CubeTable::cube (ids[j]), n, forward_);
+					pushed[j] = !solver->solve_with_assumption ();
+				}
+			}));
+		}
+		for (int i = 0; i < num_threads; ++i)
+			threads[i].join ();
+		stats_->count_main_solver_SAT_time_end ();
+	}
+	
+	template <bool Forward>
+	bool CarEngine<Forward>::propagate (const Cube& cu, int n){
+		flush_deads ();
 		solver_->set_assumption (cu, n, forward_);
 		//solver_->print_assumption();
 		//solver_->print_clauses();
@@ -374,13 +502,57 @@ namespace car
 		stats_->count_main_solver_SAT_time_end ();
 		if (!res)
 			return true;
+		//the state in cu of the model refutes other cubes of F_[n] as well
+		if (sample_)
+			push_witnesses_.push_back (state_pair (solver_->get_state (!forward_, partial_state_)).second);
+		return false;
+	}
+	
+	//A state reachable in exactly n+1 steps (forward) or a witness of a failed push from F_[n]
+	//inside \@ cu means that \@ cu cannot be pushed to F_[n+1], no solver call is needed.
+	template <bool Forward>
+	bool CarEngine<Forward>::refuted_by_samples (const Cube& cu, int n){
+		int latch_start = model_->num_inputs () + 1;
+		for (int i = 0; i < push_witnesses_.size (); i ++){
+			Assignment& st = push_witnesses_[i];
+			bool in = true;
+			for (int j = 0; j < cu.size () && in; j ++){
+				int pos = abs (cu[j]) - latch_start;
+				in = pos < st.size () && st[pos] == cu[j];
+			}
+			if (in)
+				return true;
+		}
+		
+		if (sampler_ == NULL)
+			return false;
+		while (samples_.size () <= n+1){
+			samples_.push_back (vector<BitSim::Word> ());
+			sampler_->sample (samples_.back ());
+		}
+		//SIM_WORDS words of valid patterns, then SIM_WORDS words for each latch
+		vector<BitSim::Word>& sample = samples_[n+1];
+		BitSim::Word mask[SIM_WORDS];
+		for (int w = 0; w < SIM_WORDS; w ++)
+			mask[w] = sample[w];
+		for (int j = 0; j < cu.size (); j ++){
+			const BitSim::Word* v = &sample[(abs (cu[j]) - latch_start + 1) * SIM_WORDS];
+			BitSim::Word m = cu[j] < 0 ? ~BitSim::Word (0) : 0;
+			for (int w = 0; w < SIM_WORDS; w ++)
+				mask[w] &= v[w] ^ m;
+		}
+		for (int w = 0; w < SIM_WORDS; w ++){
+			if (mask[w] != 0)
+				return true;
+		}
 		return false;
 	}
 	
 		
 	//////////////helper functions/////////////////////////////////////////////
 
-	Checker::Checker (Model* model, Statistics& stats, ofstream* dot, bool forward, bool evidence, bool partial, bool propagate, bool begin, bool end, bool inter, bool rotate, bool verbose, bool minimal_uc, bool ilock)
+	template <bool Forward>
+	CarEngine<Forward>::CarEngine (Model* model, Statistics& stats, ofstream* dot, bool evidence, bool partial, bool propagate, bool begin, bool end, bool inter, bool rotate, bool verbose, bool minimal_uc, bool ilock, bool phase, bool share, int lift, bool blift, bool rsim, bool sample)
 	{
 	    
 		model_ = model;
@@ -391,12 +563,21 @@ namespace car
 		dead_solver_ = NULL;
 		start_solver_ = NULL;
 		inv_solver_ = NULL;
+		learnt_pool_ = NULL;
+		sim_ = NULL;
+		sampler_ = NULL;
 		init_ = new State (model_->init ());
 		last_ = NULL;
-		forward_ = forward;
 		safe_reported_ = false;
 		minimal_uc_ = minimal_uc;
 		ilock_ = ilock;
+		phase_ = phase;
+		share_ = share;
+		lift_mode_ = lift;
+		backward_lift_ = !Forward && partial && blift;
+		random_sim_ = rsim;
+		sample_ = sample;
+		try_counter_ = 0;
 		evidence_ = evidence;
 		verbose_ = verbose;
 		minimal_update_level_ = F_.size ()-1;
@@ -412,7 +593,8 @@ namespace car
 		inter_ = inter;
 		rotate_ = rotate;
 	}
-	Checker::~Checker ()
+	template <bool Forward>
+	CarEngine<Forward>::~CarEngine ()
 	{
 		if (init_ != NULL)
 		{
@@ -425,9 +607,15 @@ namespace car
 		    last_ = NULL;
 		}
 		car_finalization ();
+		//deads_ lives across the outputs, so the cubes are only dropped here
+		deads_.clear ();
+		dead_index_.clear ();
+		CubeTable::clear ();
+		State::release_slabs ();
 	}
 	
-	void Checker::destroy_states ()
+	template <bool Forward>
+	void CarEngine<Forward>::destroy_states ()
 	{    
 	    for (int i = 0; i < B_.size (); i ++)
 	    {
@@ -443,15 +631,43 @@ namespace car
 	        }
 	    }
 	    B_.clear ();
+	    state_index_.clear ();
 	}
 	
-	void Checker::car_initialization ()
+	template <bool Forward>
+	void CarEngine<Forward>::car_initialization ()
 	{
-	    solver_ = new MainSolver (model_, stats_, verbose_);
+	    //each solver encodes the gates in the polarity it uses bad in
+	    solver_ = new MainSolver (model_, stats_, verbose_, bad_);
+	    //main () only accepts -share for forward CAR
+	    assert (forward_ || !share_);
 	    if (forward_){
-	    	lift_ = new MainSolver (model_, stats_, verbose_);
-	    	dead_solver_ = new MainSolver (model_, stats_, verbose_);
+	    	lift_ = new MainSolver (model_, stats_, verbose_, -bad_);
+	    	dead_solver_ = new MainSolver (model_, stats_, verbose_, -bad_);
 	    	dead_solver_->add_clause (-bad_);
+	    	if (partial_state_ && lift_mode_ != SAT_LIFT)
+	    		sim_ = new TernarySim (model_);
+	    	
+	    	//solver_ and lift_ hold the dead cube clauses unguarded, so their learnt clauses may depend on them,
+	    	//which is sound since flush_deads adds each dead clause to all three solvers at once.
+	    	//dead_solver_ also holds -bad_ unguarded, so it only imports
+	    	if (share_) {
+	    		//the three solvers are new and no dead clause is queued, so they start with the same dead clauses
+	    		assert (pending_deads_.size () == 0);
+	    		learnt_pool_ = new LearntPool (model_->max_id ());
+	    		solver_->set_learnt_pool (learnt_pool_, true);
+	    		lift_->set_learnt_pool (learnt_pool_, true);
+	    		dead_solver_->set_learnt_pool (learnt_pool_, false);
+	    	}
+	    }
+	    if (forward_ && sample_){
+	    	sampler_ = new BitSim (model_);
+	    	sampler_->start_sampling ();
+	    }
+	    if (backward_lift_){
+	    	lift_ = new MainSolver (model_, stats_, verbose_);
+	    	sim_ = new TernarySim (model_);
+	    	compute_private_inputs ();
 	    }
 		start_solver_ = new StartSolver (model_, bad_, forward_, verbose_);
 		assert (F_.empty ());
@@ -460,19 +676,27 @@ namespace car
 		
 	}
 	
-	void Checker::car_finalization ()
+	template <bool Forward>
+	void CarEngine<Forward>::car_finalization ()
 	{
 	/*
 		for (int i = 0; i < F_.size(); ++i){
 			cout << "Frame " << i << endl;
 			for (int j = 0; j < F_[i].size(); ++j)
-				car::print (F_[i][j]);
+				car::print (CubeTable::cube (F_[i][j]));
 		}
 		*/
 		
 	    F_.clear ();
+	    F_index_.clear ();
 		frame_.clear();
+		frame_index_.clear ();
 		cubes_.clear();
+		phase_models_.clear ();
+		private_inputs_.clear ();
+		//the queued dead clauses use the flags of the solvers deleted below
+		pending_deads_.clear ();
+		pending_start_deads_.clear ();
 	    destroy_states ();
 	    if (solver_ != NULL) {
 	        delete solver_;
@@ -494,10 +718,28 @@ namespace car
 	        delete inv_solver_;
 	        inv_solver_ = NULL;
 	    }
+	    if (sim_ != NULL) {
+	        delete sim_;
+	        sim_ = NULL;
+	    }
+	    if (sampler_ != NULL) {
+	        delete sampler_;
+	        sampler_ = NULL;
+	    }
+	    samples_.clear ();
+	    if (learnt_pool_ != NULL) {
+	        delete learnt_pool_;
+	        learnt_pool_ = NULL;
+	    }
+	    for (int i = 0; i < push_solvers_.size (); i ++)
+	    	delete push_solvers_[i];
+	    push_solvers_.clear ();
+	    push_loaded_.clear ();
 	}
 	
 	
-	bool Checker::immediate_satisfiable ()
+	template <bool Forward>
+	bool CarEngine<Forward>::immediate_satisfiable ()
 	{
 	    bool res = solver_solve_with_assumption (init_->s (), bad_);
 	    if (res)
@@ -515,7 +757,8 @@ namespace car
 	    return false;
 	}
 	
-	void Checker::initialize_sequences ()
+	template <bool Forward>
+	void CarEngine<Forward>::initialize_sequences ()
 	{
 		Frame frame;
 	    if (forward_)
@@ -524,7 +767,7 @@ namespace car
 		    {
 		        Cube cu;
 		        cu.push_back (-init_->element (i));
-		        frame.push_back (cu);
+		        frame.push_back (CubeTable::intern (cu));
 		    }
 		}
 		else
@@ -536,17 +779,21 @@ namespace car
 	             report_safe ();
 	             return;
 	        }
-	        frame.push_back (cu);
+	        frame.push_back (CubeTable::intern (cu));
 		comms_.push_back (cu);
 		}
 		F_.push_back (frame);
+		F_index_.push_back (CubeIndex ());
+		for (int i = 0; i < frame.size (); i ++)
+			F_index_.back ().add (frame[i]);
 		Cube& cu = init_->s();
 		cubes_.push_back (cu);
 		solver_->add_new_frame (frame, F_.size()-1, forward_);
 	}
 	
 		
-	State* Checker::enumerate_start_state ()
+	template <bool Forward>
+	State* CarEngine<Forward>::enumerate_start_state ()
 	{
 		while (true)
 		{
@@ -566,7 +813,8 @@ namespace car
 		return NULL;
 	}
 	
-	State* Checker::get_new_start_state ()
+	template <bool Forward>
+	State* CarEngine<Forward>::get_new_start_state ()
 	{
 		Assignment st = start_solver_->get_model ();
 		assert (st.size() >= model_->num_inputs() + model_->num_latches());
@@ -578,7 +826,8 @@ namespace car
 		return res;
 	}
 	
-	std::pair<Assignment, Assignment> Checker::state_pair (const Assignment& st)
+	template <bool Forward>
+	std::pair<Assignment, Assignment> CarEngine<Forward>::state_pair (const Assignment& st)
 	{
 		Assignment inputs, latches;
 		if (!partial_state_){
@@ -605,7 +854,8 @@ namespace car
 	
 	
 	
-	bool Checker::immediate_satisfiable (const State* s)
+	template <bool Forward>
+	bool CarEngine<Forward>::immediate_satisfiable (const State* s)
 	{
 	    if (forward_)
 	    {//s is actually the initial state
@@ -623,6 +873,9 @@ namespace car
 	            const_cast<State*> (s)->set_last_inputs (pa.first);
 	            last_ = new State (const_cast<State*>(s));
 	            last_->set_final (true);
+	            //s may be partial, keep the full state reaching bad for the evidence
+	            if (backward_lift_)
+	            	last_->set_s (pa.second);
 	            //////generate dot data
 	            if (dot_ != NULL)
 	                (*dot_) << "\n\t\t\t" << last_->id () << " [shape = circle, color = red, label = \"final\", size = 0.01];";
@@ -634,7 +887,8 @@ namespace car
 	}
 	
 	//a copy for cube
-	bool Checker::immediate_satisfiable (const Cube& cu)
+	template <bool Forward>
+	bool CarEngine<Forward>::immediate_satisfiable (const Cube& cu)
 	{
 	    if (forward_)
 	    {
@@ -647,10 +901,13 @@ namespace car
 	    }
 	}
 	
-	bool Checker::invariant_found (int frame_level)
+	template <bool Forward>
+	bool CarEngine<Forward>::invariant_found (int frame_level)
 	{
 		if (frame_level == 0)
 			return false;
+		if (invariant_threads_ > 1 && frame_level - minimal_update_level_ > INVARIANT_MIN_LEVELS)
+			return invariant_found_in_parallel (frame_level);
 		bool res = false;
 		create_inv_solver ();
 		for (int i = 0; i < frame_level; i ++)
@@ -659,8 +916,10 @@ namespace car
 			{
 				res = true;
 				//delete frames after i, and the left F_ is the invariant
-				while (F_.size () > i+1)
+				while (F_.size () > i+1){
 					F_.pop_back ();
+					F_index_.pop_back ();
+				}
 				//cout << "invariant found at frame " << i << endl;
 				break;
 			}
@@ -669,8 +928,64 @@ namespace car
 		return res;
 	}
 	
+	//Thread k checks the levels start+k, start+k+num_threads, ... above minimal_update_level_ on its own
+	//InvSolver, which keeps the OR constraints of the lower levels. A level not below the lowest one
+	//found so far is skipped, so the result is the level invariant_found_at () stops at.
+	template <bool Forward>
+	bool CarEngine<Forward>::invariant_found_in_parallel (int frame_level)
+	{
+		int start = minimal_update_level_ < 0 ? 0 : minimal_update_level_ + 1;
+		int num_threads = invariant_threads_;
+		if (num_threads > frame_level - start)
+			num_threads = frame_level - start;
+		std::vector<InvSolver*> solvers;
+		for (int k = 0; k < num_threads; ++k){
+			solvers.push_back (new InvSolver (model_));
+			add_dead_to_inv_solver (solvers[k]);
+		}
+		
+		std::atomic<int> found (frame_level);
+		std::vector<std::thread> threads;
+		stats_->count_inv_solver_SAT_time_start ();
+		for (int k = 0; k < num_threads; ++k){
+			threads.push_back (std::thread ([&, k] () {
+				InvSolver* solver = solvers[k];
+				int added = 0;  //F_[0..added-1] are in solver
+				for (int i = start + k; i < found.load (); i += num_threads){
+					for (; added < i; ++added)
+						solver->add_constraint_or (F_[added], forward_);
+					solver->add_constraint_and (F_[i], forward_);
+					bool res = !solver->solve_with_assumption ();
+					solver->release_constraint_and ();
+					if (res){
+						int cur = found.load ();
+						while (i < cur && !found.compare_exchange_weak (cur, i))
+							;
+						break;
+					}
+				}
+			}));
+		}
+		for (int k = 0; k < num_threads; ++k)
+			threads[k].join ();
+		stats_->count_inv_solver_SAT_time_end ();
+		for (int k = 0; k < num_threads; ++k)
+			delete solvers[k];
+		
+		int i = found.load ();
+		if (i == frame_level)
+			return false;
+		//delete frames after i, and the left F_ is the invariant
+		while (F_.size () > i+1){
+			F_.pop_back ();
+			F_index_.pop_back ();
+		}
+		return true;
+	}
+	
 	//irrelevant with the direction, so don't care forward or backward
-	bool Checker::invariant_found_at (const int frame_level) 
+	template <bool Forward>
+	bool CarEngine<Forward>::invariant_found_at (const int frame_level) 
 	{
 
 		if (frame_level <= minimal_update_level_){
@@ -690,58 +1005,223 @@ namespace car
 	}
 	
 	
-	void Checker::inv_solver_add_constraint_or (const int frame_level)
+	template <bool Forward>
+	void CarEngine<Forward>::inv_solver_add_constraint_or (const int frame_level)
 	{
 		//add \bigcup F_i (\bigcup B_i)
 		inv_solver_->add_constraint_or (F_[frame_level], forward_);
 	}
 	
-	void Checker::inv_solver_add_constraint_and (const int frame_level)
+	template <bool Forward>
+	void CarEngine<Forward>::inv_solver_add_constraint_and (const int frame_level)
 	{
 		//add \neg F_{frame_level} (\neg B_{frame_level})
 		inv_solver_->add_constraint_and (F_[frame_level], forward_);
 	}
 	
-	void Checker::inv_solver_release_constraint_and ()
+	template <bool Forward>
+	void CarEngine<Forward>::inv_solver_release_constraint_and ()
 	{
 		inv_solver_->release_constraint_and ();
 	}
 	
-	bool Checker::solve_with (const Cube& s, const int frame_level)
+	template <bool Forward>
+	bool CarEngine<Forward>::solve_with (const Cube& s, const int frame_level)
 	{
 		if (frame_level == -1)
 			return immediate_satisfiable (s);
-				
+		
+		if (phase_)
+			set_phase_hints (s, frame_level);
 		bool res = solver_solve_with_assumption (s, frame_level, forward_);
 		
 		return res;
 	}
 	
-	bool Checker::solve_for_recursive (Cube& s, int frame_level, Cube& tmp_block){
+	//the state searched from \@ cu is usually close to \@ cu and to the last state found at the same frame level,
+	//so let the solver decide on their values first. The last model goes first so that \@ cu overrides it.
+	template <bool Forward>
+	void CarEngine<Forward>::set_phase_hints (const Cube& cu, const int frame_level)
+	{
+		if (frame_level < phase_models_.size ())
+		{
+			Assignment& last = phase_models_[frame_level];
+			for (int i = 0; i < last.size (); i ++)
+				solver_->set_phase (phase_id (last[i]));
+		}
+		for (int i = 0; i < cu.size (); i ++)
+			solver_->set_phase (phase_id (cu[i]));
+	}
+	
+	template <bool Forward>
+	void CarEngine<Forward>::save_phase_model (State* s, const int frame_level)
+	{
+		while (phase_models_.size () <= frame_level)
+			phase_models_.push_back (Assignment ());
+		Assignment& last = phase_models_[frame_level];
+		last = s->inputs_vec ();
+		last.insert (last.end (), s->s().begin (), s->s().end ());
+	}
+	
+	//forward CAR searches predecessors, whose latches are the current variables;
+	//backward CAR searches successors, whose latches are the next variables
+	template <bool Forward>
+	int CarEngine<Forward>::phase_id (const int id)
+	{
+		if (forward_ || !model_->latch_var (abs (id)))
+			return id;
+		return model_->prime (id);
+	}
+	
+	template <bool Forward>
+	bool CarEngine<Forward>::solve_for_recursive (Cube& s, int frame_level, Cube& tmp_block){
 		assert (frame_level != -1);
-		
+		flush_deads ();
 		return solver_->solve_with_assumption_for_temporary (s, frame_level, forward_, tmp_block);
 				
 	}
 	
-	State* Checker::get_new_state (const State* s)
+	template <bool Forward>
+	State* CarEngine<Forward>::get_new_state (const State* s)
 	{
 		Assignment st = solver_->get_state (forward_, partial_state_);
 		//st includes both input and latch parts
-		if (partial_state_)
+		Assignment pre;
+		if (backward_lift_){
+			pre = solver_->get_model ();
+			pre.resize (model_->num_inputs () + model_->num_latches ());
+			lift_successor (st, pre);
+		}
+		else if (partial_state_)
 			get_partial (st, s);
 		std::pair<Assignment, Assignment> pa = state_pair (st);
 		State* res = new State (s, pa.first, pa.second, forward_);
+		if (backward_lift_)
+			res->set_pre_latches (state_pair (pre).second);
 		
 		return res;
 	}
 	
-	void Checker::get_partial (Assignment& st, const State* s){
+	//owner[id] is the only latch whose next-state function reads id, -1 if none, and -2 if more than one
+	inline void merge_owner (vector<int>& owner, const int id, const int latch){
+		if (owner[id] == -1)
+			owner[id] = latch;
+		else if (owner[id] != latch)
+			owner[id] = -2;
+	}
+	
+	template <bool Forward>
+	void CarEngine<Forward>::compute_private_inputs (){
+		vector<int> owner (model_->max_id () + 1, -1);
+		int latch_start = model_->num_inputs () + 1;
+		for (int i = 0; i < model_->num_latches (); i ++)
+			merge_owner (owner, abs (model_->prime (latch_start + i)), i);
+		const vector<int>& constraints = model_->constraints ();
+		for (int i = 0; i < constraints.size (); i ++)
+			merge_owner (owner, abs (constraints[i]), -2);
+		//gates are in topological order, so the owner of a gate is settled before its fanins
+		vector<Gate>& gates = model_->gates ();
+		for (int i = gates.size () - 1; i >= 0; i --){
+			int latch = owner[gates[i].lhs];
+			if (latch == -1)
+				continue;
+			merge_owner (owner, abs (gates[i].rhs0), latch);
+			merge_owner (owner, abs (gates[i].rhs1), latch);
+		}
+		
+		private_inputs_.resize (model_->num_latches ());
+		for (int i = 1; i <= model_->num_inputs (); i ++){
+			if (owner[i] >= 0)
+				private_inputs_[owner[i]].push_back (i);
+		}
+	}
+	
+	//In backward CAR the states must stay reachable, so a latch is dropped from the successor \@ st of
+	//the full assignment \@ pre only if its private inputs alone can flip its next value. As the private
+	//inputs of different latches are disjoint, every combination of the dropped latches is a successor of \@ pre.
+	template <bool Forward>
+	void CarEngine<Forward>::lift_successor (Assignment& st, const Assignment& pre){
+		sim_->set_state (pre);
+		sim_->simulate ();
+		
+		//pre as the assumption, with the private inputs of the tried latch cleared
+		Cube assumption;
+		for (int i = 0; i < pre.size (); i ++){
+			if (pre[i] != 0)
+				assumption.push_back (pre[i]);
+		}
+		
+		Assignment res;
+		for (auto it = st.begin (); it != st.end (); ++it){
+			if (!model_->latch_var (abs (*it))){
+				res.push_back (*it);
+				continue;
+			}
+			vector<int>& inputs = private_inputs_[abs (*it) - model_->num_inputs () - 1];
+			int next = model_->prime (abs (*it));
+			//X in simulation is necessary but not sufficient for the value to be flipped
+			if (inputs.empty () || sim_->value_with_x (inputs, next) != TernarySim::X){
+				res.push_back (*it);
+				continue;
+			}
+			Cube cu;
+			for (int i = 0; i < assumption.size (); i ++){
+				if (abs (assumption[i]) > model_->num_inputs () || 
+				    !std::binary_search (inputs.begin (), inputs.end (), abs (assumption[i])))
+					cu.push_back (assumption[i]);
+			}
+			cu.push_back (*it > 0 ? -next : next);
+			if (!lift_->solve_with_assumption (cu))
+				res.push_back (*it);
+		}
+		st = res;
+	}
+	
+	//The inputs kept in a state of backward CAR lead the full state in its pre_ to a state which may differ
+	//from the one its successor is reached from after lifting, so compute the inputs again along the evidence.
+	template <bool Forward>
+	void CarEngine<Forward>::concretize_evidence (){
+		Assignment latches = last_->s ();
+		for (State* st = last_; st->pre () != NULL; st = st->pre ()){
+			Cube cu = st->pre_latches ();
+			for (int i = 0; i < latches.size (); i ++){
+				int next = model_->prime (abs (latches[i]));
+				cu.push_back (latches[i] > 0 ? next : -next);
+			}
+			bool ret = lift_->solve_with_assumption (cu);
+			assert (ret);
+			Assignment inputs = lift_->get_model ();
+			inputs.resize (model_->num_inputs ());
+			st->set_inputs (inputs);
+			latches = st->pre_latches ();
+		}
+	}
+	
+	template <bool Forward>
+	void CarEngine<Forward>::get_partial (Assignment& st, const State* s){
 		if (!forward_) 
 			return;
+		flush_deads ();
+		//the inputs are kept so that the lifted state still tells how to reach s
+		Assignment inputs (st.begin (), st.begin () + model_->num_inputs ());
+		if (lift_mode_ != SAT_LIFT){
+			vector<int> targets = model_->constraints ();
+			if (s != NULL){
+				for (auto it = s->s().begin(); it != s->s().end(); ++it)
+					targets.push_back (model_->prime (*it));
+			}
+			else
+				targets.push_back (bad_);
+			//SAT is only called when simulation cannot free half of the latches, or cannot lift
+			//at all since the constraints or the targets do not hold without X
+			if (sim_->lift (st, targets) && 
+			    (lift_mode_ == SIM_LIFT || 2 * (st.size () - model_->num_inputs ()) <= model_->num_latches ()))
+				return;
+		}
+		
 		Cube assumption = st;
 		if (s != NULL){
-			Cube& cube = s->s();
+			const Cube& cube = s->s();
 			Clause cl;
 			for (auto it = cube.begin(); it != cube.end(); ++it)
 				cl.push_back (-model_->prime (*it));
@@ -757,15 +1237,12 @@ namespace car
 			assert (!ret);
 			bool constraint = false;
 			st = lift_->get_conflict (!forward_, minimal_uc_, constraint);
+			//the clause is only for this call, disable it for good
+			lift_->add_clause (flag);
 			if (st.empty()){
 			//every state can reach s, thus make st the initial state.
 				st = init_->s();
-				return;
 			}
-			
-		///?????????????????
-			lift_->add_clause (-flag);	
-			//lift_->print_clauses ();
 		}
 		else{
 			assumption.push_back (-bad_);
@@ -785,28 +1262,131 @@ namespace car
 			
 			assert (!st.empty());
 		}
+		st.insert (st.begin (), inputs.begin (), inputs.end ());
 	}
 	
 	
-	void Checker::extend_F_sequence ()
+	template <bool Forward>
+	void CarEngine<Forward>::extend_F_sequence ()
 	{
 		F_.push_back (frame_);
+		F_index_.push_back (frame_index_);
 		cubes_.push_back (cube_);
 		comms_.push_back (comm_);
 		solver_->add_new_frame (frame_, F_.size()-1, forward_);
 	}
 	
-	void Checker::update_B_sequence (State* s)
+	//If a state with the same latches is in B_, \@ s is deleted and that state is returned instead,
+	//taking the path of \@ s if it is shorter. The state keeps its place in B_ then, as B_ may be being iterated.
+	template <bool Forward>
+	State* CarEngine<Forward>::update_B_sequence (State* s)
 	{
+		size_t h = CubeTable::hash (s->s ());
+		auto range = state_index_.equal_range (h);
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			State* old = it->second;
+			if (old->s () != s->s ())
+				continue;
+			if (s->depth () < old->depth ())
+				old->relink (s);
+			delete s;
+			return old;
+		}
+		state_index_.insert (std::pair<size_t, State*> (h, s));
+		
 	    while (int (B_.size ()) <= s->depth ())
 	    {
 	        vector<State*> v;
 	        B_.push_back (v);
 	    }
 	    B_[s->depth ()].push_back (s);
+	    return s;
+	}
+	
+	//Evict states by evict_policy_ until the estimated memory of B_ is 3/4 of max_state_bytes_. Only the states
+	//no other state in B_ is found from are evicted, so the path of every state left is kept for the evidence.
+	//It is called between the rounds of do_search (), when no path is being searched.
+	template <bool Forward>
+	void CarEngine<Forward>::evict_states ()
+	{
+		size_t bytes = 0;
+		for (int i = 0; i < B_.size (); i ++)
+			for (int j = 0; j < B_[i].size (); j ++)
+				bytes += B_[i][j]->footprint ();
+		if (bytes <= max_state_bytes_)
+			return;
+		size_t target = max_state_bytes_ - max_state_bytes_ / 4;
+		
+		//the number of states in B_ found from each state, kept up to date as states are evicted
+		unordered_map<State*, int> parents;
+		for (int i = 0; i < B_.size (); i ++)
+			for (int j = 0; j < B_[i].size (); j ++)
+				parents[B_[i][j]->parent (forward_)] ++;
+		
+		while (bytes > target)
+		{
+			//the states added to dead_solver_ stay, as their predecessors are not checked for deadness again
+			vector<State*> victims;
+			for (int i = 0; i < B_.size (); i ++)
+				for (int j = 0; j < B_[i].size (); j ++)
+					if (parents.find (B_[i][j]) == parents.end () && !B_[i][j]->added_to_dead_solver ())
+						victims.push_back (B_[i][j]);
+			if (victims.empty ())
+				break;
+			if (evict_policy_ == EVICT_DEEP)
+				std::stable_sort (victims.begin (), victims.end (), [](State* a, State* b) {return a->depth () > b->depth ();});
+			else if (evict_policy_ == EVICT_SCORE)
+				std::stable_sort (victims.begin (), victims.end (), [](State* a, State* b) {return a->try_level () > b->try_level ();});
+			else
+				std::stable_sort (victims.begin (), victims.end (), [](State* a, State* b) {return a->last_try () < b->last_try ();});
+			size_t freed = 0;
+			int num = 0;
+			while (num < victims.size () && bytes - freed > target)
+				freed += victims[num++]->footprint ();
+			victims.resize (num);
+			
+			unordered_set<State*> evicted (victims.begin (), victims.end ());
+			for (int i = 0; i < B_.size (); i ++)
+			{
+				int k = 0;
+				for (int j = 0; j < B_[i].size (); j ++)
+				{
+					if (evicted.find (B_[i][j]) != evicted.end ())
+					{
+						auto it = parents.find (B_[i][j]->parent (forward_));
+						if (-- it->second == 0)
+							parents.erase (it);
+						remove_from_state_index (B_[i][j]);
+						delete B_[i][j];
+					}
+					else
+						B_[i][k++] = B_[i][j];
+				}
+				B_[i].resize (k);
+			}
+			bytes -= freed;
+		}
+		if (verbose_)
+			cout << "B_ is cut to about " << bytes / 1024 << " KB" << endl;
+	}
+	
+	template <bool Forward>
+	void CarEngine<Forward>::remove_from_state_index (State* s)
+	{
+		auto range = state_index_.equal_range (CubeTable::hash (s->s ()));
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			if (it->second == s)
+			{
+				state_index_.erase (it);
+				return;
+			}
+		}
 	}
 	
-	void Checker::update_F_sequence (const State* s, const int frame_level)
+	template <bool Forward>
+	void CarEngine<Forward>::update_F_sequence (const State* s, const int frame_level)
 	{	
 		bool constraint = false;
 		Cube cu = solver_->get_conflict (forward_, minimal_uc_, constraint);
@@ -826,7 +1406,7 @@ namespace car
 		//foward cu MUST rule out those not in \@s
 		if (forward_){
 			Cube tmp;
-			Cube &st = s->s();
+			const Cube &st = s->s();
 			if (!partial_state_){
 				for(auto it = cu.begin(); it != cu.end(); ++it){
 					int latch_start = model_->num_inputs()+1;
@@ -891,13 +1471,14 @@ namespace car
 		
 	}
 	
-	bool Checker::is_dead (const State* s, Cube& dead_uc){
-	
+	template <bool Forward>
+	bool CarEngine<Forward>::is_dead (const State* s, Cube& dead_uc){
+		flush_deads ();
 		Cube assumption;
 		
 		Cube common;
 		if (deads_.size() > 0) 
-			common = car::cube_intersect (deads_[deads_.size()-1], s->s());
+			common = car::cube_intersect (CubeTable::cube (deads_[deads_.size()-1]), s->s());
 			
 		for (auto it = common.begin(); it != common.end(); ++it)
 			assumption.push_back (forward_ ? model_->prime (*it) : (*it));
@@ -908,7 +1489,7 @@ namespace car
 		/*
 		Cube common;
 		if (deads_.size() > 0) 
-			common = car::cube_intersect (deads_[deads_.size()-1], s->s());
+			common = car::cube_intersect (CubeTable::cube (deads_[deads_.size()-1]), s->s());
 		for (auto it = common.begin(); it != common.end(); ++it)
 			assumption.push_back (forward_ ? model_->prime (*it) : (*it));
 		//assumption.insert (assumption.begin (), common.begin (), common.end ());
@@ -918,7 +1499,7 @@ namespace car
 		/*
 		if (!s->added_to_dead_solver ()){
 			dead_solver_->CARSolver::add_clause_from_cube (s->s());
-			s->set_added_to_dead_solver (true);
+			const_cast<State*> (s)->set_added_to_dead_solver (true);
 		}
 		*/
 			
@@ -929,7 +1510,7 @@ namespace car
 			//foward dead_cu MUST rule out those not in \@s //TO BE REUSED!
 			if (forward_){
 				Cube tmp;
-				Cube &st = s->s();
+				const Cube &st = s->s();
 				if (!partial_state_){
 					for(auto it = dead_uc.begin(); it != dead_uc.end(); ++it){
 						int latch_start = model_->num_inputs()+1;
@@ -983,31 +1564,33 @@ namespace car
 		else{
 			if (!s->added_to_dead_solver ()){
 				dead_solver_->CARSolver::add_clause_from_cube (s->s());
-				s->set_added_to_dead_solver (true);
+				const_cast<State*> (s)->set_added_to_dead_solver (true);
 			}
 		}
 		return !res;
 	}
 	
-	void Checker::add_dead_to_inv_solver (){
+	template <bool Forward>
+	void CarEngine<Forward>::add_dead_to_inv_solver (InvSolver* solver){
 		for (auto it = deads_.begin (); it != deads_.end(); ++it){
+			const Cube& dead = CubeTable::cube (*it);
 			Clause cl;	
-			for (auto it2 = (*it).begin(); it2 != (*it).end (); ++it2){
+			for (auto it2 = dead.begin(); it2 != dead.end (); ++it2){
 				cl.push_back (forward_? -(*it2) : -model_->prime(*it2));
 			}
 		
-			if (is_initial (*it)){
+			if (is_initial (dead)){
 				//create dead clauses : MUST consider the initial state not excluded by dead states!!!
 				std::vector<Clause> cls;
-				int init_flag = inv_solver_->new_var ();
-				int dead_flag = inv_solver_->new_var ();
+				int init_flag = solver->new_var ();
+				int dead_flag = solver->new_var ();
 				if (true){//not consider initial state yet
 					Clause cl2;
 					
 					cl2.push_back (init_flag);
 					cl2.push_back (dead_flag);
 					cls.push_back (cl2);
-					//create clauses for I <- inv_solver_->init_flag
+					//create clauses for I <- solver->init_flag
 					for (auto it2 = init_->s().begin(); it2 != init_->s().end(); ++it2){
 						cl2.clear ();
 						cl2.push_back (init_flag);
@@ -1020,29 +1603,36 @@ namespace car
 				cls.push_back (cl);
 		
 				for (auto it2 = cls.begin(); it2 != cls.end(); ++it2){
-					inv_solver_->add_clause (*it2);
+					solver->add_clause (*it2);
 				}
 			}
 			else
-				inv_solver_->add_clause (cl);
+				solver->add_clause (cl);
 		}
 	}
 	
-	void Checker::add_dead_to_solvers (Cube& dead_uc){
-		std::vector<Cube> tmp_deads;
+	//The clauses are queued and added to the solvers by flush_deads () before their next call.
+	template <bool Forward>
+	void CarEngine<Forward>::add_dead_to_solvers (Cube& dead_uc){
+		//drop the dead cubes subsumed by dead_uc
+		uint64_t sig = CubeTable::signature_of (dead_uc);
+		std::vector<int> tmp_deads;
 		for (auto it = deads_.begin (); it != deads_.end (); ++it){
-			if (!imply (*it, dead_uc))
+			if (CubeTable::may_imply (CubeTable::signature (*it), sig) && imply (CubeTable::cube (*it), dead_uc))
+				dead_index_.remove (*it);
+			else
 				tmp_deads.push_back (*it);
 		}
 		deads_ = tmp_deads;
-		deads_.push_back (dead_uc);
+		deads_.push_back (CubeTable::intern (dead_uc));
+		dead_index_.add (deads_.back ());
 		//car::print (dead_uc);
 		
 		Clause cl;	
 		for (auto it = dead_uc.begin(); it != dead_uc.end (); ++it){
 			cl.push_back (forward_? -(*it) : -model_->prime(*it));
 		}
-		start_solver_->add_clause (cl);
+		pending_start_deads_.push (cl.data (), cl.size ());
 		
 		if (is_initial (dead_uc)){
 			//create dead clauses : MUST consider the initial state not excluded by dead states!!!
@@ -1065,22 +1655,17 @@ namespace car
 			cl.push_back (-solver_->dead_flag());
 			cls.push_back (cl);
 		
-			for (auto it = cls.begin(); it != cls.end(); ++it){
-				solver_->add_clause (*it);
-				lift_->add_clause (*it);
-				dead_solver_->add_clause (*it);
-			}
-		}
-		else{
-			solver_->add_clause (cl);
-			lift_->add_clause (cl);
-			dead_solver_->add_clause (cl);
+			for (auto it = cls.begin(); it != cls.end(); ++it)
+				pending_deads_.push (it->data (), it->size ());
 		}
+		else
+			pending_deads_.push (cl.data (), cl.size ());
 			
 	}
 	
 	
-	Cube Checker::recursive_block (State* s, int frame_level, Cube cu, Cube& next_cu){
+	template <bool Forward>
+	Cube CarEngine<Forward>::recursive_block (State* s, int frame_level, Cube cu, Cube& next_cu){
 		
 		Cube common = s->s();
 		State *tmp_s = new State (common);
@@ -1121,7 +1706,8 @@ namespace car
 		
 	}
 	
-	Cube Checker::get_uc (Cube &c) {
+	template <bool Forward>
+	Cube CarEngine<Forward>::get_uc (Cube &c) {
 		bool constraint = false;
 		Cube cu = solver_->get_conflict (forward_, minimal_uc_, constraint);
 		    
@@ -1144,32 +1730,47 @@ namespace car
 	}
 
 	
-	void Checker::push_to_frame (Cube& cu, const int frame_level)
+	template <bool Forward>
+	void CarEngine<Forward>::push_to_frame (Cube& cu, const int frame_level)
+	{
+		push_to_frame (CubeTable::intern (cu), frame_level);
+	}
+	
+	template <bool Forward>
+	void CarEngine<Forward>::push_to_frame (const int id, const int frame_level)
 	{
 		
 		Frame& frame = (frame_level < int (F_.size ())) ? F_[frame_level] : frame_;
-		
+		CubeIndex& index = (frame_level < int (F_.size ())) ? F_index_[frame_level] : frame_index_;
+		const Cube& cu = CubeTable::cube (id);
+		uint64_t sig = CubeTable::signature (id);
 				
 		//To add \@ cu to \@ frame, there must be
 		//1. \@ cu does not imply any clause in \@ frame
 		//2. if a clause in \@ frame implies \@ cu, replace it by \@cu
+		//the signatures rule out most pairs before the literals are compared
 		Frame tmp_frame;
+		std::vector<int> removed;
 		stats_->count_clause_contain_time_start ();
 		for (int i = 0; i < frame.size (); i ++)
 		{   
+			uint64_t sig2 = CubeTable::signature (frame[i]);
 			if (forward_){//for incremental
-				if (imply (cu, frame[i]))
+				if (CubeTable::may_imply (sig, sig2) && imply (cu, CubeTable::cube (frame[i])))
 					return;
 			}
-			if (!imply (frame[i], cu))
+			if (!CubeTable::may_imply (sig2, sig) || !imply (CubeTable::cube (frame[i]), cu))
 				tmp_frame.push_back (frame[i]);	
 			else {
-				
+				removed.push_back (frame[i]);
 			    stats_->count_clause_contain_success ();
 			}
 		} 
 		stats_->count_clause_contain_time_end ();
-		tmp_frame.push_back (cu);
+		tmp_frame.push_back (id);
+		for (int i = 0; i < removed.size (); i ++)
+			index.remove (removed[i]);
+		index.add (id);
 		/*
 		//update comm
 		Cube& comm = (frame_level < int (comms_.size ())) ? comms_[frame_level] : comm_;
@@ -1191,71 +1792,57 @@ namespace car
 	}
 	
 	
-	int Checker::get_new_level (const State *s, const int frame_level){
+	//whether a cube of F_[frame_level] (frame_ if it is F_.size ()) contains \@ s
+	template <bool Forward>
+	bool CarEngine<Forward>::blocked_at (const State* s, const int frame_level){
+		CubeIndex& index = (frame_level < int (F_.size ())) ? F_index_[frame_level] : frame_index_;
+		Cube& st = const_cast<State*>(s)->s();
+		return index.find_subset (st, [&](int id) {
+			return partial_state_ ? car::imply (st, CubeTable::cube (id)) : s->imply (CubeTable::cube (id));
+		}) != -1;
+	}
+	
+	template <bool Forward>
+	int CarEngine<Forward>::get_new_level (const State *s, const int frame_level){
 	    for (int i = 0; i < frame_level; i ++){
-	        int j = 0;
-	        for (; j < F_[i].size (); j ++){
-	        	bool res = partial_state_ ? car::imply (s->s(), F_[i][j]) : s->imply (F_[i][j]);
-	            if (res)
-	                break;
-	        }
-	        if (j >= F_[i].size ())
+	        if (!blocked_at (s, i))
 	            return i-1;
 	    }
 		return frame_level - 1;
 	}
 	
-	bool Checker::tried_before (const State* st, const int frame_level) {
+	template <bool Forward>
+	bool CarEngine<Forward>::tried_before (const State* st, const int frame_level) {
 		//check whether st is a dead state	
 		if (st->is_dead ()) 
 			return true;
-		for(auto it = deads_.begin(); it != deads_.end(); ++it){
-			bool res = partial_state_ ? car::imply (st->s(), *it) : st->imply (*it);
-			res = res && !is_initial (st->s());
-			if (res){
-				st->mark_dead ();
-				return true;
-			}
+		Cube& cu = const_cast<State*>(st)->s();
+		bool contained = dead_index_.find_subset (cu, [&](int id) {
+			return partial_state_ ? car::imply (cu, CubeTable::cube (id)) : st->imply (CubeTable::cube (id));
+		}) != -1;
+		if (contained && !is_initial (cu)){
+			const_cast<State*> (st)->mark_dead ();
+			return true;
 		}
 		//end of check
 		
 	    assert (frame_level >= 0);
-	    Frame &frame = (frame_level < F_.size ()) ? F_[frame_level] : frame_;
-	    if (!partial_state_){
-	    	//assume that st is a full state
-	    	assert (const_cast<State*>(st)->size () == model_->num_latches ());
-	    
-	    	stats_->count_state_contain_time_start ();
-	    	for (int i = 0; i < frame.size (); i ++) {
-	        	if (st->imply (frame[i])) {
-	            	stats_->count_state_contain_time_end ();
-	            	return true;
-	        	} 
-	    	}
-	    	stats_->count_state_contain_time_end ();
-	    }
-	    else{
-	    	stats_->count_state_contain_time_start ();
-	    	for (int i = 0; i < frame.size (); i ++) {
-	        	if (car::imply (st->s(), frame[i])) {
-	            	stats_->count_state_contain_time_end ();
-	            	return true;
-	        	} 
-	    	}
-	    	stats_->count_state_contain_time_end ();
-	    }
-	   
-	    
-	    return false;
+	    //assume that st is a full state
+	    assert (partial_state_ || const_cast<State*>(st)->size () == model_->num_latches ());
+	    stats_->count_state_contain_time_start ();
+	    bool res = blocked_at (st, frame_level);
+	    stats_->count_state_contain_time_end ();
+	    return res;
 	}
 	
 	
-	void Checker::get_previous (const Assignment& st, const int frame_level, std::vector<int>& res) {
+	template <bool Forward>
+	void CarEngine<Forward>::get_previous (const Assignment& st, const int frame_level, std::vector<int>& res) {
 	    if (frame_level == -1) return;
 	    Frame& frame = (frame_level < F_.size ()) ? F_[frame_level] : frame_;
 	    
 	    for (int i = frame.size ()-1; i >= 0; --i) {
-	        Cube& cu = frame[i];
+	        const Cube& cu = CubeTable::cube (frame[i]);
 	        int j = 0;
 	        for (; j < cu.size() ; ++ j) {
 	    	    if (st[abs(cu[j])-model_->num_inputs ()-1] != cu[j]) {
@@ -1270,7 +1857,8 @@ namespace car
 	}
 	
 	//collect priority ids and store in \@ res
-	void Checker::get_priority (const Assignment& st, const int frame_level, std::vector<int>& res) {
+	template <bool Forward>
+	void CarEngine<Forward>::get_priority (const Assignment& st, const int frame_level, std::vector<int>& res) {
 	    
 	    //get_previous (st, frame_level, res);
 	    
@@ -1278,26 +1866,16 @@ namespace car
 	    if (frame.size () == 0)  
 	    	return;
 	    	
-	    Cube& cu = frame[frame.size()-1];
+	    const Cube& cu = CubeTable::cube (frame[frame.size()-1]);
 	        
-	    std::vector<int> tmp;
-	    tmp.reserve (cu.size());
-	    if(!forward_){
-	    	for (int i = 0; i < cu.size() ; ++ i) {
-	    		if (st[abs(cu[i])-model_->num_inputs ()-1] == cu[i]) {
-	    			tmp.push_back (cu[i]);
-	    		}
-	    	}
-	    	res = tmp;
-	    }
-	    else{
-	    	res = car::cube_intersect (cu, st);
-	    }
+	    //st may be partial in both directions, so it cannot be indexed by the latches
+	    res = car::cube_intersect (cu, st);
 	    //res.insert (res.begin (), tmp.begin (), tmp.end ());
 	}
 	
 	//add the intersection of the last UC in frame_level+1 with the state \@ st to \@ st
-	void Checker::add_intersection_last_uc_in_frame_level_plus_one (Assignment& st, const int frame_level) {
+	template <bool Forward>
+	void CarEngine<Forward>::add_intersection_last_uc_in_frame_level_plus_one (Assignment& st, const int frame_level) {
 		/*
 	    std::vector<int> tmp;
 	    get_priority (st, frame_level, tmp);
@@ -1349,15 +1927,25 @@ namespace car
 	        //cube = st;
 	        return;
 	    }
+	    //st and cube may be partial, so the value of each latch in st is looked up instead of st itself
+	    std::vector<int> val (model_->num_latches (), 0);
+	    for (int i = 0; i < st.size (); ++ i)
+	        val[abs(st[i])-model_->num_inputs ()-1] = st[i];
 	    for (int i = 0; i < cube.size (); ++ i) {
-	        if (st[abs(cube[i])-model_->num_inputs ()-1] == cube[i]) 
+	        int& v = val[abs(cube[i])-model_->num_inputs ()-1];
+	        if (v == cube[i]) 
 	    		tmp_st.push_back (cube[i]);
-	    	else
+	    	else if (v == -cube[i])
 	    	    tmp.push_back (-cube[i]);
+	    	v = 0;
 	    }
 	    
 	    for (int i = 0; i < tmp.size (); ++ i)
 	        tmp_st.push_back (tmp[i]);
+	    //the latches of st not in cube keep their order at the end
+	    for (int i = 0; i < st.size (); ++ i)
+	        if (val[abs(st[i])-model_->num_inputs ()-1] != 0)
+	            tmp_st.push_back (st[i]);
 	        
 	    st = tmp_st;
 	    //cube = st;
@@ -1378,11 +1966,28 @@ namespace car
 	}
 	
 		
-	void Checker::print_evidence (ofstream& out) {
+	template <bool Forward>
+	void CarEngine<Forward>::print_evidence (ofstream& out) {
 		if (forward_)
-			init_->print_evidence (forward_, out);
-		else
-			last_->print_evidence (forward_, out);
+			init_->print_evidence (forward_, out, init_line ());
+		else{
+			if (backward_lift_)
+				concretize_evidence ();
+			last_->print_evidence (forward_, out, init_line ());
+		}
+	}
+	
+	template <bool Forward>
+	const bool CarEngine<Forward>::forward_;
+	
+	template class CarEngine<true>;
+	template class CarEngine<false>;
+	
+	Checker* new_checker (Model* model, Statistics& stats, ofstream* dot, bool forward, bool evidence, bool partial, bool propagate, bool begin, bool end, bool inter, bool rotate, bool verbose, bool minimal_uc, bool ilock, bool phase, bool share, int lift, bool blift, bool rsim, bool sample)
+	{
+		if (forward)
+			return new CarEngine<true> (model, stats, dot, evidence, partial, propagate, begin, end, inter, rotate, verbose, minimal_uc, ilock, phase, share, lift, blift, rsim, sample);
+		return new CarEngine<false> (model, stats, dot, evidence, partial, propagate, begin, end, inter, rotate, verbose, minimal_uc, ilock, phase, share, lift, blift, rsim, sample);
 	}
 		
 }
@@ -29,17 +29,37 @@
 #include "startsolver.h"
 #include "mainsolver.h"
 #include "model.h"
+#include "ternarysim.h"
+#include "bitsim.h"
 #include <assert.h>
 #include "utility.h"
 #include "statistics.h"
 #include <fstream>
 #include <algorithm>
+#include <unordered_set>
+#include <unordered_map>
 
 #define MAX_SOLVER_CALL 500
 #define MAX_TRY 4
+#define PROPAGATE_MIN_CUBES 8  //fewer cubes of a frame are pushed on solver_ alone
+#define INVARIANT_MIN_LEVELS 4  //fewer candidate levels are checked on inv_solver_ alone
 
 namespace car 
 {
+    //how to lift a state to a partial state in forward CAR
+    enum LiftMode {
+        SAT_LIFT,     //UC of lift_
+        SIM_LIFT,     //ternary simulation
+        HYBRID_LIFT   //ternary simulation, then lift_ if too few latches are freed
+    };
+    
+    //which states to evict first when B_ is full
+    enum EvictPolicy {
+        EVICT_LRU,    //least recently tried
+        EVICT_DEEP,   //deepest
+        EVICT_SCORE   //lowest score, i.e. the highest of the lowest frame levels the states were tried at
+    };
+    
     class Comparator {
     public:
         //Comparator (std::vector<int>& counter): counter_ (counter) {}
@@ -56,11 +76,48 @@ namespace car
         Model* model_;
     };
     
-	class Checker 
+	//The interface of the engines for main (), see new_checker ()
+	class Checker
 	{
 	public:
-		Checker (Model* model, Statistics& stats, std::ofstream* dot, bool forward = true, bool evidence = false, bool partial = false, bool propagate = false, bool begin = false, bool end = true, bool inter = true, bool rotate = false, bool verbose = false, bool minimal_uc = false,bool ilock = false);
-		~Checker ();
+		Checker () : output_base_ (0), max_state_bytes_ (0), evict_policy_ (EVICT_LRU), propagate_threads_ (0), invariant_threads_ (0) {}
+		virtual ~Checker () {}
+		
+		virtual bool check (std::ofstream&) = 0;
+		virtual void print_evidence (std::ofstream&) = 0;
+		virtual int frame_size () = 0;
+		virtual void print_frames_sizes () = 0;
+		//the model is sliced for output \@ output of the original one, whose initial latch values are \@ init
+		inline void set_origin (const int output, const std::string& init) {
+			output_base_ = output;
+			init_line_ = init;
+		}
+		//check the pushes of a frame on \@ num threads in propagation, 0 or 1 for solver_ alone
+		inline void set_propagate_threads (const int num) {propagate_threads_ = num;}
+		//check the frame levels for an invariant on \@ num threads, 0 or 1 for inv_solver_ alone
+		inline void set_invariant_threads (const int num) {invariant_threads_ = num;}
+		//keep the estimated memory of the states in B_ under \@ max_bytes, 0 for no limit
+		inline void set_state_memory (const size_t max_bytes, const int policy) {
+			max_state_bytes_ = max_bytes;
+			evict_policy_ = policy;
+		}
+	protected:
+		int output_base_;  //index of output 0 in the witness
+		std::string init_line_;  //initial latch values in the witness, those of init_ if empty
+		size_t max_state_bytes_;  //the limit of the estimated memory of the states in B_, 0 for no limit
+		int evict_policy_;  //EvictPolicy
+		int propagate_threads_;
+		int invariant_threads_;
+	};
+	
+	//The CAR engine searching in the direction \@ Forward, so that the branches on forward_ are
+	//resolved at compile time. Both directions are instantiated in checker.cpp.
+	template <bool Forward>
+	class CarEngine : public Checker
+	{
+	public:
+		CarEngine (Model* model, Statistics& stats, std::ofstream* dot, bool evidence = false, bool partial = false, bool propagate = false, bool begin = false, bool end = true, bool inter = true, bool rotate = false, bool verbose = false, bool minimal_uc = false,bool ilock = false, bool phase = false, bool share = false, int lift = SAT_LIFT, bool blift = false, bool rsim = false, bool sample = false);
+		~CarEngine ();
 		
 		bool check (std::ofstream&);
 		void print_evidence (std::ofstream&);
@@ -73,13 +130,21 @@ namespace car
 		}
 	protected:
 		//flags 
-		bool forward_;
+		static const bool forward_ = Forward;
 		bool partial_state_;
 		bool minimal_uc_;
 		bool evidence_;
 		bool verbose_;
 		bool propagate_;
 		bool ilock_;
+		bool phase_;  //set phase hints before searching a new state
+		bool share_;  //share learnt clauses between solver_, lift_ and dead_solver_
+		int lift_mode_; //LiftMode for partial states
+		bool backward_lift_; //lift successor states in backward CAR
+		bool random_sim_; //look for a counterexample by random simulation first
+		bool sample_;  //reject pushes in propagation by known states
+		std::vector<MainSolver*> push_solvers_;  //one for each thread in propagation
+		std::vector<std::vector<std::unordered_set<int> > > push_loaded_;  //the cubes of each frame loaded into push_solvers_[i]
 		
 		//new flags for reorder and state enumeration
 		bool begin_, end_;  // for state enumeration
@@ -102,8 +167,18 @@ namespace car
 		MainSolver *lift_, *dead_solver_;
 		StartSolver *start_solver_;
 		InvSolver *inv_solver_;
+		LearntPool *learnt_pool_;
+		TernarySim *sim_;
+		BitSim *sampler_;  //forward only, simulates from the initial state
+		std::vector<std::vector<BitSim::Word> > samples_;  //states reachable in exactly i steps, packed as BitSim::sample ()
+		std::vector<Assignment> push_witnesses_;  //states refuting pushes from the frame in propagation
+		std::vector<std::vector<int> > private_inputs_;  //for each latch, the inputs read by no other next-state function nor constraint
 		Fsequence F_;
+		std::vector<CubeIndex> F_index_;  //the cubes of F_[i]
+		CubeIndex frame_index_;           //the cubes of frame_
 		Bsequence B_;
+		std::unordered_multimap<size_t, State*> state_index_;  //the states in B_ by the hashes of their latches
+		int try_counter_;   //the number of calls to try_satisfy_by, to stamp the states
 		Frame frame_;   //to store the frame willing to be added in F_ in one step
 		
 	    
@@ -116,8 +191,13 @@ namespace car
 	    std::vector<State*> states_;
 	    std::vector<Cube> comms_;
 	    Cube comm_; 
-	    std::vector<Cube> deads_;
+	    std::vector<int> deads_;  //ids in CubeTable
+	    CubeIndex dead_index_;  //the cubes of deads_
+	    ClauseArena pending_deads_;        //clauses of new dead cubes, not yet added to solver_, lift_ and dead_solver_
+	    ClauseArena pending_start_deads_;  //those not yet added to start_solver_
 	    bool dead_flag_;
+	    
+	    std::vector<Assignment> phase_models_; //phase_models_[i] is the last state (with inputs) found at frame level i
 		
 		bool safe_reported_;  //true means ready to return SAFE
 		//functions
@@ -130,17 +210,25 @@ namespace car
 		bool try_satisfy_by (int frame_level, State* s);
 		bool invariant_found (int frame_level);
 		bool invariant_found_at (const int frame_level);
+		bool invariant_found_in_parallel (int frame_level);
 		void inv_solver_add_constraint_or (const int frame_level);
 		void inv_solver_add_constraint_and (const int frame_level);
 		void inv_solver_release_constraint_and ();
 		bool solve_with (const Cube &cu, const int frame_level);
+		void set_phase_hints (const Cube& cu, const int frame_level);
+		void save_phase_model (State* s, const int frame_level);
+		int phase_id (const int id);
 		State* get_new_state (const State *s);
 		void extend_F_sequence ();
 		void update_F_sequence (const State* s, const int frame_level);
 		void update_frame_by_relative (const State* s, const int frame_level);
-		void update_B_sequence (State* s);
+		State* update_B_sequence (State* s);
+		void remove_from_state_index (State* s);
+		void evict_states ();
+		bool blocked_at (const State* s, const int frame_level);
 		int get_new_level (const State *s, const int frame_level);
 		void push_to_frame (Cube& cu, const int frame_level);
+		void push_to_frame (const int id, const int frame_level);
 		bool tried_before (const State* s, const int frame_level);
 		
 		
@@ -152,8 +240,13 @@ namespace car
 		void car_finalization ();
 		void destroy_states ();
 		bool car_check ();
+		bool random_check (std::ofstream& out, const int output);
+		inline std::string init_line () {return init_line_.empty () ? init_->latches () : init_line_;}
 		
 		void get_partial (Assignment& st, const State* s=NULL);
+		void compute_private_inputs ();
+		void lift_successor (Assignment& st, const Assignment& pre);
+		void concretize_evidence ();
 		void add_dead_to_solvers (Cube& dead_uc);
 		bool is_dead (const State* s, Cube& dead_uc);
 		
@@ -164,16 +257,19 @@ namespace car
 		//propagation
 		bool propagate ();
 		bool propagate (int n);
-		bool propagate (Cube& cu, int n);
+		bool propagate (const Cube& cu, int n);
+		void propagate_in_parallel (const std::vector<int>& ids, const int n, std::vector<char>& pushed);
+		void sync_push_solver (const int i, const int n);
+		bool refuted_by_samples (const Cube& cu, int n);
 		
-		void add_dead_to_inv_solver ();
+		void add_dead_to_inv_solver (InvSolver* solver);
 				
 		
 		//inline functions
-		inline bool is_initial (Cube& c){return init_->imply (c);}
+		inline bool is_initial (const Cube& c){return init_->imply (c);}
 		inline void create_inv_solver (){
 			inv_solver_ = new InvSolver (model_, verbose_);
-			add_dead_to_inv_solver ();
+			add_dead_to_inv_solver (inv_solver_);
 		}
 		inline void delete_inv_solver (){
 			delete inv_solver_;
@@ -191,7 +287,7 @@ namespace car
 	        start_solver_->reset ();
 	        if (propagate_){
 	        	for (int i = 0; i < frame_.size(); ++i)
-	        		start_solver_->add_clause_with_flag (frame_[i]);
+	        		start_solver_->add_clause_with_flag (CubeTable::cube (frame_[i]));
 	        	
 	        }
 	    }
@@ -209,15 +305,30 @@ namespace car
 	        delete start_solver_;
 	        start_solver_ = new StartSolver (model_, bad_, forward_, verbose_);
 	        for (int i = 0; i < frame_.size (); i ++) {
-	            start_solver_->add_clause_with_flag (frame_[i]);
+	            start_solver_->add_clause_with_flag (CubeTable::cube (frame_[i]));
 	        }
 	        
 	    }
 	    
+	    //add the queued clauses of the dead cubes to the solvers
+	    inline void flush_deads () {
+	    	if (pending_start_deads_.size () > 0) {
+	    		start_solver_->add_clauses (pending_start_deads_, 0, pending_start_deads_.size ());
+	    		pending_start_deads_.clear ();
+	    	}
+	    	if (pending_deads_.size () > 0) {
+	    		solver_->add_clauses (pending_deads_, 0, pending_deads_.size ());
+	    		lift_->add_clauses (pending_deads_, 0, pending_deads_.size ());
+	    		dead_solver_->add_clauses (pending_deads_, 0, pending_deads_.size ());
+	    		pending_deads_.clear ();
+	    	}
+	    }
+	    
 	    inline bool start_solver_solve_with_assumption (){
 	        //if (reconstruct_start_solver_required ())
 	            //reconstruct_start_solver ();
-	            
+	        flush_deads ();
+	        
 	        stats_->count_start_solver_SAT_time_start ();
 	    	bool res = start_solver_->solve_with_assumption ();
 	    	stats_->count_start_solver_SAT_time_end ();
@@ -244,6 +355,7 @@ namespace car
 	    inline bool solver_solve_with_assumption (const Assignment& st, const int p){
 	        //if (reconstruct_solver_required ())
 	            //reconstruct_solver ();
+	        flush_deads ();
 	        Assignment st2 = st;
 	        add_intersection_last_uc_in_frame_level_plus_one (st2, -1);
 	        stats_->count_main_solver_SAT_time_start ();
@@ -251,8 +363,9 @@ namespace car
 	        stats_->count_main_solver_SAT_time_end ();
 	        if (!res) {
 	        	Assignment st3; 
-		    	st3.reserve (model_->num_latches());
-		    	for (int i = st2.size ()-model_->num_latches(); i < st2.size (); ++ i)
+		    	st3.reserve (st.size());
+		    	//st2 is the priority prefix followed by the reordered st, which may be partial
+		    	for (int i = st2.size ()-st.size(); i < st2.size (); ++ i)
 		    		st3.push_back (st2[i]);
 
 	            if (0 < cubes_.size ()) 
@@ -266,6 +379,7 @@ namespace car
 	    inline bool solver_solve_with_assumption (const Assignment& st, const int frame_level, bool forward){
 	        //if (reconstruct_solver_required ())
 	            //reconstruct_solver ();
+	        flush_deads ();
 	        Assignment st2 = st;
 	        add_intersection_last_uc_in_frame_level_plus_one (st2, frame_level);
 	        solver_->set_assumption (st2, frame_level, forward);
@@ -274,8 +388,9 @@ namespace car
 		    stats_->count_main_solver_SAT_time_end ();
 		    if (!res) {
 		    	Assignment st3; 
-		    	st3.reserve (model_->num_latches());
-		    	for (int i = st2.size ()-model_->num_latches(); i < st2.size (); ++ i)
+		    	st3.reserve (st.size());
+		    	//st2 is the priority prefix followed by the reordered st, which may be partial
+		    	for (int i = st2.size ()-st.size(); i < st2.size (); ++ i)
 		    		st3.push_back (st2[i]);
 		        if (frame_level+1 < cubes_.size ()) 
 		            cubes_[frame_level+1] = st3;
@@ -287,16 +402,17 @@ namespace car
 	    
 	    inline void clear_frame (){
 	        frame_.clear ();
+	        frame_index_.clear ();
 	        cube_.clear ();
 		comm_.clear ();
 	        for (int i = 0; i < frame_.size (); i ++)
-	        	start_solver_->add_clause_with_flag (frame_[i]);
+	        	start_solver_->add_clause_with_flag (CubeTable::cube (frame_[i]));
 	    }
 	    
 	    
 	    inline void print_frame (const Frame& f){
 	        for (int i = 0; i < f.size (); i ++)
-	            car::print (f[i]);
+	            car::print (CubeTable::cube (f[i]));
 	    }
 	    
 	    inline void print_F (){
@@ -323,5 +439,8 @@ namespace car
 	    }
 	    
 	};
+	
+	//the engine for the direction \@ forward, which is chosen only here
+	Checker* new_checker (Model* model, Statistics& stats, std::ofstream* dot, bool forward = true, bool evidence = false, bool partial = false, bool propagate = false, bool begin = false, bool end = true, bool inter = true, bool rotate = false, bool verbose = false, bool minimal_uc = false,bool ilock = false, bool phase = false, bool share = false, int lift = SAT_LIFT, bool blift = false, bool rsim = false, bool sample = false);
 }
 #endif
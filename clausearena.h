@@ -0,0 +1,79 @@
+/*
+    Copyright (C) 2018, Jianwen Li (lijwen2748@gmail.com), Iowa State University
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+	Author: Jianwen Li
+	Update Date: October 19, 2026
+	Clauses stored in one contiguous array of literals
+*/
+
+#ifndef CLAUSE_ARENA_H
+#define CLAUSE_ARENA_H
+
+#include <vector>
+
+namespace car
+{
+	//Clause i is lits_[offsets_[i]] ... lits_[offsets_[i+1]-1]. A clause is built by add ()
+	//on its literals followed by close ().
+	class ClauseArena
+	{
+	public:
+		ClauseArena () : offsets_ (1, 0) {}
+		~ClauseArena () {}
+
+		inline int size () const {return offsets_.size () - 1;}
+		inline const int* clause (const int i) const {return lits_.data () + offsets_[i];}
+		inline int clause_size (const int i) const {return offsets_[i+1] - offsets_[i];}
+		inline const int* lits () const {return lits_.data ();}
+		inline const int* offsets () const {return offsets_.data ();}
+
+		inline void add (const int lit) {lits_.push_back (lit);}
+		inline void close () {offsets_.push_back (lits_.size ());}
+
+		inline void push (const int id) {add (id); close ();}
+		inline void push (const int id1, const int id2) {add (id1); add (id2); close ();}
+		inline void push (const int* lits, const int size) {
+			lits_.insert (lits_.end (), lits, lits + size);
+			close ();
+		}
+
+		//append the clauses of \@ other
+		inline void append (const ClauseArena& other) {
+			int base = lits_.size ();
+			lits_.insert (lits_.end (), other.lits_.begin (), other.lits_.end ());
+			for (int i = 1; i < other.offsets_.size (); i ++)
+				offsets_.push_back (base + other.offsets_[i]);
+		}
+
+		inline void clear () {
+			lits_.clear ();
+			offsets_.assign (1, 0);
+		}
+
+		inline void reserve (const int num_clauses, const int num_lits) {
+			offsets_.reserve (num_clauses + 1);
+			lits_.reserve (num_lits);
+		}
+
+	private:
+		std::vector<int> lits_;
+		std::vector<int> offsets_;
+	};
+}
+
+#endif
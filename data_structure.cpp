@@ -60,8 +60,13 @@
  		else
  		    dep_ = s->dep_ + 1;
 		work_count_ = 0;
+		work_level_ = 0;
+		last_try_ = 0;
+		try_level_ = INT_MAX;
+		final_ = false;
 		dead_ = false;
 		added_to_dead_solver_ = false;
+		computed_next_ = false;
  	}
  	
  	bool State::imply (const Cube& cu) const
@@ -89,12 +94,12 @@
 		return res;
 	}
  	
- 	void State::print_evidence (bool forward, ofstream& out)
+ 	void State::print_evidence (bool forward, ofstream& out, const string& init)
  	{
  		State* nx = this;
 	    if (forward)
 	    {
-	        out << nx->latches () << endl;
+	        out << init << endl;
 	    	out << nx->inputs ()  << endl;
 	    	while (nx->next() != NULL)
 	    	{
@@ -118,7 +123,7 @@
 	    	for (int i = tmp.size ()-1; i >= 0; i --)
 	    	{
 	    		if (i == tmp.size() - 1) //init state
-	    		    out << start->latches () << endl;
+	    		    out << init << endl;
 	    		out << tmp[i] << endl;
 	    	}
 	    
@@ -178,9 +183,95 @@
  		return res;
  	}
  	
+ 	std::vector<Cube> CubeTable::cubes_;
+ 	std::vector<uint64_t> CubeTable::signatures_;
+ 	std::unordered_multimap<size_t, int> CubeTable::index_;
+ 	
+ 	size_t CubeTable::hash (const Cube& cu)
+ 	{
+ 		size_t res = cu.size ();
+ 		for (int i = 0; i < cu.size (); i ++)
+ 			res = res * 31 + size_t (cu[i]);
+ 		return res;
+ 	}
+ 	
+ 	int CubeTable::intern (const Cube& cu)
+ 	{
+ 		size_t h = hash (cu);
+ 		auto range = index_.equal_range (h);
+ 		for (auto it = range.first; it != range.second; ++it)
+ 		{
+ 			if (cubes_[it->second] == cu)
+ 				return it->second;
+ 		}
+ 		int id = cubes_.size ();
+ 		cubes_.push_back (cu);
+ 		signatures_.push_back (signature_of (cu));
+ 		index_.insert (std::pair<size_t, int> (h, id));
+ 		return id;
+ 	}
+ 	
+ 	void CubeTable::clear ()
+ 	{
+ 		cubes_.clear ();
+ 		signatures_.clear ();
+ 		index_.clear ();
+ 	}
+ 	
+ 	void CubeIndex::remove (const int id)
+ 	{
+ 		std::vector<int>& ids = index_[key (id)];
+ 		for (int i = 0; i < ids.size (); i ++)
+ 		{
+ 			if (ids[i] == id)
+ 			{
+ 				ids[i] = ids.back ();
+ 				ids.pop_back ();
+ 				return;
+ 			}
+ 		}
+ 	}
+ 	
  	int State::num_inputs_ = 0;
  	int State::num_latches_ = 0;
  	int State::id_counter_ = 1;
+ 	std::vector<State*> State::slabs_;
+ 	State* State::free_list_ = NULL;
+ 	int State::slab_used_ = STATE_SLAB_SIZE;
+ 	
+ 	void* State::operator new (size_t size)
+ 	{
+ 		assert (size == sizeof (State));
+ 		if (free_list_ != NULL)
+ 		{
+ 			State* res = free_list_;
+ 			free_list_ = *reinterpret_cast<State**> (res);
+ 			return res;
+ 		}
+ 		if (slab_used_ == STATE_SLAB_SIZE)
+ 		{
+ 			slabs_.push_back (static_cast<State*> (::operator new (sizeof (State) * STATE_SLAB_SIZE)));
+ 			slab_used_ = 0;
+ 		}
+ 		return slabs_.back () + (slab_used_++);
+ 	}
+ 	
+ 	void State::operator delete (void* p)
+ 	{
+ 		if (p == NULL)
+ 			return;
+ 		*reinterpret_cast<State**> (p) = free_list_;
+ 		free_list_ = static_cast<State*> (p);
+ 	}
+ 	
+ 	void State::release_slabs ()
+ 	{
+ 		for (int i = 0; i < slabs_.size (); i ++)
+ 			::operator delete (slabs_[i]);
+ 		slabs_.clear ();
+ 		free_list_ = NULL;
+ 		slab_used_ = STATE_SLAB_SIZE;
+ 	}
  	
  	void State::set_num_inputs_and_latches (const int n1, const int n2) 
  	{
@@ -26,30 +26,107 @@
  
  #include <vector>
  #include <stdlib.h>
+ #include <stdint.h>
+ #include <limits.h>
  #include <iostream>
  #include <fstream>
+ #include <unordered_map>
+ 
+ #define STATE_SLAB_SIZE 4096  //number of states allocated at once
  
  namespace car
  {
  	typedef std::vector<int> Assignment;
  	typedef std::vector<int> Cube;
  	typedef std::vector<int> Clause;
- 	typedef std::vector<Cube> Frame;
+ 	typedef std::vector<int> Frame;   //ids of the cubes in CubeTable
  	typedef std::vector<Frame> Fsequence;
  	
+ 	//Each distinct cube (sorted by variables, as all cubes in frames) is stored once and referred to
+ 	//by its id, which never changes in a run. The signature has one bit per class of literals, so a cube
+ 	//implies another only if its signature covers the other's.
+ 	class CubeTable
+ 	{
+ 	public:
+ 		static int intern (const Cube& cu);
+ 		static inline const Cube& cube (const int id) {return cubes_[id];}
+ 		static inline uint64_t signature (const int id) {return signatures_[id];}
+ 		static inline uint64_t signature_of (const Cube& cu) {
+ 			uint64_t res = 0;
+ 			for (int i = 0; i < cu.size (); i ++)
+ 				res |= uint64_t (1) << ((uint64_t (cu[i]) * 0x9E3779B97F4A7C15ULL) >> 58);
+ 			return res;
+ 		}
+ 		//whether a cube with signature \@ a may imply one with signature \@ b
+ 		static inline bool may_imply (const uint64_t a, const uint64_t b) {return (b & ~a) == 0;}
+ 		static void clear ();
+ 		static size_t hash (const Cube& cu);
+ 		
+ 	private:
+ 		static std::vector<Cube> cubes_;
+ 		static std::vector<uint64_t> signatures_;
+ 		static std::unordered_multimap<size_t, int> index_;  //from hashes to ids
+ 	};
+ 	
+ 	//Cubes of CubeTable by their first literals. A cube contained in another cube (or a state) contains
+ 	//its first literal, so only the lists of the literals of the latter hold candidates.
+ 	class CubeIndex
+ 	{
+ 	public:
+ 		inline void add (const int id) {index_[key (id)].push_back (id);}
+ 		void remove (const int id);
+ 		inline void clear () {index_.clear ();}
+ 		
+ 		//the id of a cube in the index contained in \@ cu, -1 if none. The cubes passing the signature
+ 		//test are checked by \@ contains (id).
+ 		template <class Contains>
+ 		int find_subset (const Cube& cu, Contains contains) const {
+ 			if (index_.empty ())
+ 				return -1;
+ 			uint64_t sig = CubeTable::signature_of (cu);
+ 			for (int i = -1; i < int (cu.size ()); i ++) {
+ 				auto ids = index_.find (i == -1 ? 0 : cu[i]);
+ 				if (ids == index_.end ())
+ 					continue;
+ 				for (auto it = ids->second.begin (); it != ids->second.end (); ++it) {
+ 					if (CubeTable::may_imply (sig, CubeTable::signature (*it)) && contains (*it))
+ 						return *it;
+ 				}
+ 			}
+ 			return -1;
+ 		}
+ 		
+ 	private:
+ 		std::unordered_map<int, std::vector<int> > index_;
+ 		
+ 		//the empty cube is kept under 0
+ 		static inline int key (const int id) {
+ 			const Cube& cu = CubeTable::cube (id);
+ 			return cu.empty () ? 0 : cu[0];
+ 		}
+ 	};
+ 	
  	//state 
  	class State 
  	{
  	public:
- 	    State (const Assignment& latches) : s_ (latches), pre_ (NULL), next_ (NULL), dead_ (false), added_to_dead_solver_ (false) {}
+ 	    State (const Assignment& latches) : next_ (NULL), pre_ (NULL), s_ (latches), id_ (0), dep_ (0), last_try_ (0), try_level_ (INT_MAX), work_level_ (0), work_count_ (0), 
+ 	    detect_dead_start_ (0), init_ (false), final_ (false), dead_ (false), added_to_dead_solver_ (false), computed_next_ (false) {}
 
  		State (const State *s, const Assignment& inputs, const Assignment& latches, const bool forward, const bool last = false); 
  		
- 		State (State *s): pre_ (s->pre_), next_(s->next_), s_(s->s_), inputs_(s->inputs_), last_inputs_(s->last_inputs_), 
- 		init_ (s->init_), id_ (s->id_), dep_ (s->dep_), dead_ (false), added_to_dead_solver_ (false) {}
+ 		State (State *s): next_(s->next_), pre_ (s->pre_), s_(s->s_), inputs_(s->inputs_), last_inputs_(s->last_inputs_), pre_latches_(s->pre_latches_), 
+ 		id_ (s->id_), dep_ (s->dep_), last_try_ (s->last_try_), try_level_ (s->try_level_), work_level_ (0), work_count_ (0), detect_dead_start_ (0), 
+ 		init_ (s->init_), final_ (false), dead_ (false), added_to_dead_solver_ (false), computed_next_ (false) {}
 
  		~State () {}
  		
+ 		//states are carved out of slabs, and the freed ones are reused before a new slab is taken
+ 		static void* operator new (size_t size);
+ 		static void operator delete (void* p);
+ 		//return the slabs to the system, all states must have been deleted
+ 		static void release_slabs ();
+ 		
  		bool imply (const Cube& cu) const;
  		Cube intersect (const Cube& cu);
  		inline void set_detect_dead_start (int pos) {detect_dead_start_ = pos;}
@@ -57,6 +134,8 @@
  		
  		inline void set_inputs (const Assignment& st) {inputs_ = st;}
  		inline void set_last_inputs (const Assignment& st) {last_inputs_ = st;}
+ 		inline void set_pre_latches (const Assignment& st) {pre_latches_ = st;}
+ 		inline Assignment& pre_latches () {return pre_latches_;}
  		inline void set_initial (bool val) {init_ = val;}
  		inline void set_final (bool val) {final_ = val;}
  		inline void set_depth (int pos) {dep_ = pos;}
@@ -64,10 +143,12 @@
  		
  		inline void print () { std::cout << latches () << std::endl;}
  		
- 		void print_evidence (bool forward, std::ofstream&);
+ 		//\@ init is printed for the initial latch values
+ 		void print_evidence (bool forward, std::ofstream&, const std::string& init);
  		
  		inline int depth () {return dep_;}
  		inline Assignment& s () {return s_;}
+ 		inline const Assignment& s () const {return s_;}
  		inline State* next () {return next_;}
  		inline State* pre () {return pre_;}
  		inline Assignment& inputs_vec () {return inputs_;}
@@ -82,12 +163,34 @@
  		
  		inline void set_s (Cube &cube) {s_ = cube;}
  		inline void set_next (State* nx) {next_ = nx;}
+ 		//take the parent, the inputs and the depth of \@ s, which reaches the same latches by a shorter path
+ 		inline void relink (const State* s) {
+ 			next_ = s->next_;
+ 			pre_ = s->pre_;
+ 			inputs_ = s->inputs_;
+ 			last_inputs_ = s->last_inputs_;
+ 			pre_latches_ = s->pre_latches_;
+ 			dep_ = s->dep_;
+ 		}
  		static void set_num_inputs_and_latches (const int n1, const int n2); 
  		
  		inline void set_nexts (std::vector<int>& nexts) {nexts_ = nexts; computed_next_ = true;}
  		inline std::vector<int>& nexts () {return nexts_;}
  		inline bool computed_next () const {return computed_next_;}
  		
+ 		inline int last_try () const {return last_try_;}
+ 		inline void set_last_try (int t) {last_try_ = t;}
+ 		//the lowest frame level the state was tried at, the lower the closer it got to the other end
+ 		inline int try_level () const {return try_level_;}
+ 		inline void update_try_level (int level) {if (level < try_level_) try_level_ = level;}
+ 		//the estimated bytes of the state, its slot in the slabs and the contents of its vectors
+ 		inline size_t footprint () const {
+ 			return sizeof (State) + (s_.capacity () + inputs_.capacity () + last_inputs_.capacity () 
+ 			       + pre_latches_.capacity () + nexts_.capacity ()) * sizeof (int);
+ 		}
+ 		//the state its path goes through next, i.e. the one it was found from
+ 		inline State* parent (bool forward) {return forward ? next_ : pre_;}
+ 		
  		inline int work_level () const {return work_level_;}
  		inline void set_work_level (int id) {work_level_ = id;}
 		inline void work_count_inc () {work_count_ ++;}
@@ -95,36 +198,41 @@
  		inline int work_count_reset () {work_count_ = 0;}
  		
  		inline void mark_dead () {dead_ = true;}
- 		inline bool is_dead () {return dead_;}
+ 		inline bool is_dead () const {return dead_;}
  		inline void set_added_to_dead_solver (bool val) {added_to_dead_solver_ = val;}
- 		inline bool added_to_dead_solver () {return added_to_dead_solver_;}
+ 		inline bool added_to_dead_solver () const {return added_to_dead_solver_;}
  	private:
- 	//s_ contains all latches, but if the value of latch l is not cared, assign it to -1.
- 		Assignment s_;
  		State* next_;
  		State* pre_;
+ 	//s_ contains all latches, but if the value of latch l is not cared, assign it to -1.
+ 		Assignment s_;
  		std::vector<int> inputs_;
  		std::vector<int> last_inputs_; // for backward CAR only!
+ 		std::vector<int> pre_latches_; // the full state in pre_ this state is reached from, for backward partial states only!
+ 		std::vector<int> nexts_; //the next part which can be decided by the state without input
  		
- 		bool init_;  //whether it is an initial state
- 		bool final_; //whether it is an final state
- 		bool dead_;  //whether it is a dead state 
- 		bool added_to_dead_solver_; //whether it is added to the dead solver
  		int id_;     //the state id
  		int dep_;    //the length from the starting state
- 		
- 		bool computed_next_;  //flag to label whether the next part of the state has been computed
- 		std::vector<int> nexts_; //the next part which can be decided by the state without input
- 		
+ 		int last_try_;  //when the state was last tried in the search
+ 		int try_level_; //the lowest frame level the state was tried at, INT_MAX if never tried
  		int work_level_;
 		int work_count_;
- 		
- 		
  		int detect_dead_start_; //to store the start position to check whether it is a dead state
  		
+ 		//the flags share one word
+ 		unsigned init_ : 1;  //whether it is an initial state
+ 		unsigned final_ : 1; //whether it is an final state
+ 		unsigned dead_ : 1;  //whether it is a dead state 
+ 		unsigned added_to_dead_solver_ : 1; //whether it is added to the dead solver
+ 		unsigned computed_next_ : 1;  //flag to label whether the next part of the state has been computed
+ 		
  		static int num_inputs_;
  		static int num_latches_;
  		static int id_counter_;
+ 		
+ 		static std::vector<State*> slabs_;
+ 		static State* free_list_;   //the freed states, linked through their first word
+ 		static int slab_used_;      //the number of states taken from slabs_.back ()
  	};
  	
  	typedef std::vector<std::vector<State*> > Bsequence;
@@ -39,8 +39,15 @@ namespace car
 				model_ = const_cast<Model*> (m);
 			    verbose_ = verbose;
 			    int end = model_->outputs_start ();
+			    //only the constraints are asserted
+			    std::vector<char> pol;
+			    model_->polarities (std::vector<int> (), false, pol);
+			    ClauseArena& cls = model_->clauses ();
 			    for (int i = 0; i < end ; i ++)
-                    add_clause (model_->element (i));
+			    {
+			    	if (model_->needed (i, pol))
+                    	add_clause (cls.clause (i), cls.clause_size (i));
+                }
 			}
 			~InvSolver () {;}
 		
@@ -58,9 +65,10 @@ namespace car
  				{
  					int clause_flag = new_var ();
  					v.push_back (clause_flag);
- 					for (int j = 0; j < frame[i].size (); j ++)
+ 					const Cube& cu = CubeTable::cube (frame[i]);
+ 					for (int j = 0; j < cu.size (); j ++)
  					{
- 						int id = frame[i][j];
+ 						int id = cu[j];
  						add_clause (-clause_flag, id);
  					}
  				}
@@ -73,9 +81,10 @@ namespace car
  				for (int i = 0; i < frame.size (); i ++)
  				{
  					std::vector<int> v;
- 					for (int j = 0; j < frame[i].size (); j ++)
+ 					const Cube& cu = CubeTable::cube (frame[i]);
+ 					for (int j = 0; j < cu.size (); j ++)
  					{
- 						int id = frame[i][j];
+ 						int id = cu[j];
  						v.push_back (-id);
  					}
  					v.push_back (-frame_flag);
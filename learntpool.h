@@ -0,0 +1,106 @@
+/*
+    Copyright (C) 2018, Jianwen Li (lijwen2748@gmail.com), Iowa State University
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+	Author: Jianwen Li
+	Update Date: October 19, 2026
+	Pool of learnt clauses shared between the solvers built on the same model
+*/
+
+#ifndef LEARNT_POOL_H
+#define LEARNT_POOL_H
+
+#include <vector>
+#include <stdlib.h>
+
+#define SHARE_MAX_SIZE 8  //learnt clauses longer than it are not shared
+#define SHARE_MAX_LBD 4   //learnt clauses with larger LBD are not shared
+
+namespace car
+{
+	//Only clauses over the model variables (ids no larger than \@ max_id) are accepted,
+	//i.e. those without any frame or activation flag. Such a clause is implied by the
+	//unguarded clauses of the exporting solver, so it is the caller's duty to make sure
+	//that every importer holds all the unguarded clauses of every exporter.
+	class LearntPool
+	{
+	public:
+		LearntPool (const int max_id, const int max_size = SHARE_MAX_SIZE, const int max_lbd = SHARE_MAX_LBD) :
+			max_id_ (max_id), max_size_ (max_size), max_lbd_ (max_lbd), start_ (0), num_solvers_ (0) {}
+		~LearntPool () {}
+
+		inline int register_solver () {
+			cursors_.push_back (0);
+			return num_solvers_++;
+		}
+
+		inline bool accept (const int size, const int lbd) {
+			return size <= max_size_ && lbd <= max_lbd_;
+		}
+
+		//\@ cl has passed accept ()
+		inline void add (const std::vector<int>& cl, const int origin) {
+			for (int i = 0; i < cl.size (); i ++) {
+				if (abs (cl[i]) > max_id_)
+					return;
+			}
+			clauses_.push_back (cl);
+			origins_.push_back (origin);
+		}
+
+		//collect the clauses that \@ solver has not seen yet and were exported by others
+		inline void fetch (const int solver, std::vector<std::vector<int> >& res) {
+			int& pos = cursors_[solver];
+			for (; pos < start_ + int (clauses_.size ()); pos ++) {
+				if (origins_[pos-start_] != solver)
+					res.push_back (clauses_[pos-start_]);
+			}
+			shrink ();
+		}
+
+		inline int size () {return clauses_.size ();}
+
+	private:
+		int max_id_;
+		int max_size_;
+		int max_lbd_;
+
+		std::vector<std::vector<int> > clauses_;
+		std::vector<int> origins_;   //the solver exporting each clause
+		int start_;                  //the global position of clauses_[0]
+
+		int num_solvers_;
+		std::vector<int> cursors_;   //the global position each solver has fetched to
+
+		//drop the clauses fetched by every solver
+		inline void shrink () {
+			int min = cursors_[0];
+			for (int i = 1; i < cursors_.size (); i ++) {
+				if (cursors_[i] < min)
+					min = cursors_[i];
+			}
+			//amortize the erase
+			if (min - start_ < 1024 || 2 * (min - start_) < int (clauses_.size ()))
+				return;
+			clauses_.erase (clauses_.begin (), clauses_.begin () + (min - start_));
+			origins_.erase (origins_.begin (), origins_.begin () + (min - start_));
+			start_ = min;
+		}
+	};
+}
+
+#endif
@@ -20,6 +20,7 @@
 #include "statistics.h"
 #include "data_structure.h"
 #include "model.h"
+#include "preprocess.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -73,6 +74,26 @@ void print_usage ()
   printf ("       -end            state numeration from end of the sequence\n");
   printf ("       -interaion      enable intersection heuristic\n");
   printf ("       -rotation       enable rotation heurisitc\n");
+  printf ("       -phase          set phase hints from the current state and the last found state (Default = off)\n");
+  printf ("       -share          share learnt clauses between the solvers of forward CAR, minisat only (Default = off)\n");
+  printf ("       -sim-lift       lift partial states by ternary simulation instead of SAT (forward only)\n");
+  printf ("       -hybrid-lift    lift partial states by ternary simulation, and by SAT when it frees too few latches\n");
+  printf ("       -blift          lift successor states in backward CAR (Default = off)\n");
+  printf ("       -rsim           run random simulation for shallow counterexamples before CAR (Default = off)\n");
+  printf ("       -sample         reject pushes in propagation by sampled states before calling the solver (Default = off)\n");
+  printf ("       -fraig          merge equivalent and gates by SAT sweeping before encoding (Default = off)\n");
+  printf ("       -opt            optimize the AIG by hashing, constant propagation and balancing before encoding (Default = off)\n");
+  printf ("       -leq            merge latches equivalent to others or constants, proved by induction, before encoding (Default = off)\n");
+  printf ("       -pg             encode the gates only in the polarities they are used in (Default = off)\n");
+  printf ("       -nary           encode single-fanout and trees as n-ary and gates (Default = off)\n");
+  printf ("       -lazy           load the clauses of a gate into the solvers only once it is referenced (Default = off)\n");
+  printf ("       -simp           simplify the clauses of the main solvers by variable elimination and subsumption (Default = off)\n");
+  printf ("       -pprop <n>      check the pushes of a frame in propagation on n threads (Default = 0, on the main solver)\n");
+  printf ("       -pinv <n>       check the frame levels for an invariant on n threads (Default = 0, on one solver)\n");
+  printf ("       -bmem <n>       keep the estimated memory of the under-approximation sequence under n MB, 0 for no limit (Default = 0)\n");
+  printf ("       -evict-deep     evict the deepest states first when -bmem is reached (Default = least recently tried)\n");
+  printf ("       -evict-score    evict the states of the lowest score first, i.e. those only tried at high frame levels\n");
+  printf ("       -coi            check each output on the model sliced to its cone of influence (Default = off)\n");
   printf ("       -e              print witness (Default = off)\n");
   printf ("       -v              print verbose information (Default = off)\n");
   printf ("       -h              print help information\n");
@@ -121,6 +142,24 @@ void check_aiger (int argc, char** argv)
    bool end = true;
    bool inter = true;
    bool rotate = false;
+   bool phase = false;
+   bool share = false;
+   int lift = SAT_LIFT;
+   bool blift = false;
+   bool rsim = false;
+   bool sample = false;
+   bool fraig = false;
+   bool opt = false;
+   bool coi = false;
+   bool leq = false;
+   bool pg = false;
+   bool nary = false;
+   bool lazy = false;
+   bool simp = false;
+   int pprop = 0;
+   int pinv = 0;
+   int bmem = 0;
+   int evict = EVICT_LRU;
    
    string input;
    string output_dir;
@@ -158,6 +197,55 @@ void check_aiger (int argc, char** argv)
    			inter = true;
    		else if (strcmp (argv[i], "-rotation") == 0)
    			rotate = true;
+   		else if (strcmp (argv[i], "-phase") == 0)
+   			phase = true;
+   		else if (strcmp (argv[i], "-share") == 0)
+   			share = true;
+   		else if (strcmp (argv[i], "-sim-lift") == 0)
+   			lift = SIM_LIFT;
+   		else if (strcmp (argv[i], "-hybrid-lift") == 0)
+   			lift = HYBRID_LIFT;
+   		else if (strcmp (argv[i], "-blift") == 0)
+   			blift = true;
+   		else if (strcmp (argv[i], "-rsim") == 0)
+   			rsim = true;
+   		else if (strcmp (argv[i], "-sample") == 0)
+   			sample = true;
+   		else if (strcmp (argv[i], "-fraig") == 0)
+   			fraig = true;
+   		else if (strcmp (argv[i], "-opt") == 0)
+   			opt = true;
+   		else if (strcmp (argv[i], "-leq") == 0)
+   			leq = true;
+   		else if (strcmp (argv[i], "-pg") == 0)
+   			pg = true;
+   		else if (strcmp (argv[i], "-nary") == 0)
+   			nary = true;
+   		else if (strcmp (argv[i], "-lazy") == 0)
+   			lazy = true;
+   		else if (strcmp (argv[i], "-simp") == 0)
+   			simp = true;
+   		else if (strcmp (argv[i], "-pprop") == 0) {
+   			if (i + 1 == argc)
+   				print_usage ();
+   			pprop = atoi (argv[++i]);
+   		}
+   		else if (strcmp (argv[i], "-pinv") == 0) {
+   			if (i + 1 == argc)
+   				print_usage ();
+   			pinv = atoi (argv[++i]);
+   		}
+   		else if (strcmp (argv[i], "-bmem") == 0) {
+   			if (i + 1 == argc)
+   				print_usage ();
+   			bmem = atoi (argv[++i]);
+   		}
+   		else if (strcmp (argv[i], "-evict-deep") == 0)
+   			evict = EVICT_DEEP;
+   		else if (strcmp (argv[i], "-evict-score") == 0)
+   			evict = EVICT_SCORE;
+   		else if (strcmp (argv[i], "-coi") == 0)
+   			coi = true;
    		else if (!input_set)
    		{
    			input = string (argv[i]);
@@ -173,6 +261,19 @@ void check_aiger (int argc, char** argv)
    }
    if (!input_set || !output_dir_set)
    		print_usage ();
+   //learnt clauses are only shared between the solvers of forward CAR, and picosat does not report them
+   #ifdef ENABLE_PICOSAT
+   if (share)
+   {
+   		printf ("error: -share is not supported by simplecar-picosat\n");
+   		exit (0);
+   }
+   #endif
+   if (share && !forward)
+   {
+   		printf ("error: -share is only supported with -f\n");
+   		exit (0);
+   }
 
   //std::string output_dir (argv[3]);
   if (output_dir.at (output_dir.size()-1) != '/')
@@ -215,28 +316,85 @@ void check_aiger (int argc, char** argv)
    }
    if (!aiger_is_reencoded(aig))
      aiger_reencode(aig);
+   //the initial values in the witness are those of the model as read
+   std::string init = car::reset_line (aig);
      
    stats.count_model_construct_time_start ();
-   model = new Model (aig);
-   stats.count_model_construct_time_end ();
+   if (opt)
+   {
+     aiger* optimized = car::optimize (aig, verbose);
+     aiger_reset (aig);
+     aig = optimized;
+   }
+   if (fraig)
+   {
+     aiger* reduced = car::fraig (aig, verbose);
+     aiger_reset (aig);
+     aig = reduced;
+   }
+   if (leq)
+   {
+     aiger* merged = car::merge_latches (aig, verbose);
+     aiger_reset (aig);
+     aig = merged;
+   }
+   bool res = false;
+   if (coi)
+   {
+     //each output is checked on its own sliced model, with the witness in terms of the whole one
+     assert (aig->num_outputs >= 1);
+     stats.count_model_construct_time_end ();
+     for (unsigned i = 0; i < aig->num_outputs; i ++)
+     {
+       stats.count_model_construct_time_start ();
+       aiger* sliced = car::slice (aig, i);
+       model = new Model (sliced, false, pg, nary, lazy, simp);
+       aiger_reset (sliced);
+       stats.count_model_construct_time_end ();
+       if (verbose)
+         cout << "output " << i << ": " << model->num_latches () << " of " << aig->num_latches << " latches in the cone of influence" << endl;
+       
+       State::set_num_inputs_and_latches (model->num_inputs (), model->num_latches ());
+       ch = new_checker (model, stats, dot_file, forward, evidence, partial, propagate, begin, end, inter, rotate, verbose, minimal_uc,ilock, phase, share, lift, blift, rsim, sample);
+       ch->set_origin (i, init);
+       ch->set_state_memory ((size_t) bmem << 20, evict);
+       ch->set_propagate_threads (pprop);
+       ch->set_invariant_threads (pinv);
+       res = ch->check (res_file) || res;
+       delete ch;
+       ch = NULL;
+       delete model;
+       model = NULL;
+     }
+     aiger_reset (aig);
+   }
+   else
+   {
+     model = new Model (aig, false, pg, nary, lazy, simp);
+     stats.count_model_construct_time_end ();
    
-   if (verbose)
-    model->print ();
+     if (verbose)
+      model->print ();
    
-   State::set_num_inputs_and_latches (model->num_inputs (), model->num_latches ());
+     State::set_num_inputs_and_latches (model->num_inputs (), model->num_latches ());
    
-   //assume that there is only one output needs to be checked in each aiger model, 
-   //which is consistent with the HWMCC format
-   assert (model->num_outputs () >= 1);
+     //assume that there is only one output needs to be checked in each aiger model, 
+     //which is consistent with the HWMCC format
+     assert (model->num_outputs () >= 1);
    
-   ch = new Checker (model, stats, dot_file, forward, evidence, partial, propagate, begin, end, inter, rotate, verbose, minimal_uc,ilock);
+     ch = new_checker (model, stats, dot_file, forward, evidence, partial, propagate, begin, end, inter, rotate, verbose, minimal_uc,ilock, phase, share, lift, blift, rsim, sample);
+     ch->set_origin (0, init);
+     ch->set_state_memory ((size_t) bmem << 20, evict);
+     ch->set_propagate_threads (pprop);
+     ch->set_invariant_threads (pinv);
 
-   aiger_reset(aig);
+     aiger_reset(aig);
    
-   bool res = ch->check (res_file);
+     res = ch->check (res_file);
     
-   delete model;
-   model = NULL;
+     delete model;
+     model = NULL;
+   }
    res_file.close ();
    
    //write the dot file tail
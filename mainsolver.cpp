@@ -33,7 +33,7 @@ namespace car
 	//int MainSolver::max_flag_ = -1;
 	//vector<int> MainSolver::frame_flags_;
 	
-	MainSolver::MainSolver (Model* m, Statistics* stats, const bool verbose) 
+	MainSolver::MainSolver (Model* m, Statistics* stats, const bool verbose, const int root) 
 	{
 	    verbose_ = verbose;
 	    stats_ = stats;
@@ -41,19 +41,72 @@ namespace car
 		init_flag_ = m->max_id() + 1;
 		dead_flag_ = m->max_id () + 2;
 		max_flag_ = m->max_id() + 3;
-	    //constraints
-		for (int i = 0; i < m->outputs_start (); i ++)
-			add_clause (m->element (i));
-		//outputs
-		for (int i = m->outputs_start (); i < m->latches_start (); i ++)
-			add_clause (m->element (i));
-		//latches
-		for (int i = m->latches_start (); i < m->size (); i ++)
-		    add_clause (m->element (i));
+		if (m->simplified ())
+		{
+			//the simplified clauses have no gate definitions to filter or load
+			add_clauses (m->simp_clauses (), 0, m->simp_clauses ().size ());
+			return;
+		}
+		if (root != 0)
+			m->polarities (vector<int> (1, root), true, polarities_);
+		if (m->lazy ())
+		{
+			//only the clauses out of gates go in now, and a gate is loaded with its cone once referenced
+			lazy_ = true;
+			loading_ = false;
+			nexts_loaded_ = false;
+			loaded_.resize (m->max_id () + 1, 0);
+			ClauseArena& cls = m->clauses ();
+			for (int i = 0; i < cls.size (); i ++)
+			{
+				if (m->gate_of_clause (i) == 0)
+					add_clause (cls.clause (i), cls.clause_size (i));
+			}
+			return;
+		}
+		//constraints, outputs and latches
+		ClauseArena& cls = m->clauses ();
+		if (polarities_.empty ())
+		{
+			add_clauses (cls, 0, cls.size ());
+			return;
+		}
+		for (int i = 0; i < cls.size (); i ++)
+		{
+			if (m->needed (i, polarities_))
+				add_clause (cls.clause (i), cls.clause_size (i));
+		}
+	}
+	
+	void MainSolver::load (const int id)
+	{
+		int var = abs (id);
+		if (var >= loaded_.size () || loaded_[var])
+			return;
+		loaded_[var] = 1;
+		pending_.push_back (var);
+		//add_clause below calls back for the literals of the clauses, which are only queued
+		if (loading_)
+			return;
+		loading_ = true;
+		while (!pending_.empty ())
+		{
+			int v = pending_.back ();
+			pending_.pop_back ();
+			vector<int>& def = model_->definition (v);
+			for (int i = 0; i < def.size (); i ++)
+			{
+				if (model_->needed (def[i], polarities_))
+					add_clause (model_->clauses ().clause (def[i]), model_->clauses ().clause_size (def[i]));
+			}
+		}
+		loading_ = false;
 	}
 	
 	void MainSolver::set_assumption (const Assignment& st, const int id)
 	{
+		//a gate encoded in one polarity must not be assumed in the other
+		assert (model_->encoded (id, polarities_));
 		assumption_.clear ();
 		assumption_push (id);
 		
@@ -68,19 +121,31 @@ namespace car
 		assumption_.clear ();
 		if (frame_level > -1)
 			assumption_push (flag_of (frame_level));		
-		for (Assignment::const_iterator it = a.begin (); it != a.end (); it ++)
+		//the direction is fixed for a solver, so it is tested once and not for each literal
+		if (forward)
 		{
-			int id = *it;
-			if (forward)
-				assumption_push (model_->prime (id));
-			else
-				assumption_push (id);
+			for (Assignment::const_iterator it = a.begin (); it != a.end (); it ++)
+				assumption_push (model_->prime (*it));
+		}
+		else
+		{
+			for (Assignment::const_iterator it = a.begin (); it != a.end (); it ++)
+				assumption_push (*it);
 		}
-			
 	}
 	
 	Assignment MainSolver::get_state (const bool forward, const bool partial)
 	{
+		//the next values of all latches are read, so once their cones are loaded the
+		//model is computed again, which only extends the current one to the new gates
+		if (lazy_ && !forward && !nexts_loaded_)
+		{
+			nexts_loaded_ = true;
+			for (int i = model_->num_inputs ()+1; i <= model_->num_inputs () + model_->num_latches (); i ++)
+				load (model_->prime (i));
+			bool res = solve_assumption ();
+			assert (res);
+		}
 		Assignment model = get_model ();
 		shrink_model (model, forward, partial);
 		return model;
@@ -128,7 +193,7 @@ namespace car
 	{
 		for (int i = 0; i < frame.size (); i ++)
 		{
-			add_clause_from_cube (frame[i], frame_level, forward);
+			add_clause_from_cube (CubeTable::cube (frame[i]), frame_level, forward);
 		}
 	}
 	
@@ -137,13 +202,16 @@ namespace car
 		int flag = flag_of (frame_level);
 		vector<int> cl;
 		cl.push_back (-flag);
-		for (int i = 0; i < cu.size (); i ++)
+		if (forward)
 		{
-			if (!forward)
-				cl.push_back (-model_->prime (cu[i]));
-			else
+			for (int i = 0; i < cu.size (); i ++)
 				cl.push_back (-cu[i]);
 		}
+		else
+		{
+			for (int i = 0; i < cu.size (); i ++)
+				cl.push_back (-model_->prime (cu[i]));
+		}
 		add_clause (cl);
 	}
 	
@@ -37,7 +37,9 @@ namespace car{
 class MainSolver : public CARSolver 
 {
 	public:
-		MainSolver (Model*, Statistics* stats, const bool verbose = false);
+		//With the polarity-aware encoding of the model, only the gates needed for assuming or asserting \@ root
+		//and the next values of latches are encoded, and 0 keeps the full encoding for other uses.
+		MainSolver (Model*, Statistics* stats, const bool verbose = false, const int root = 0);
 		~MainSolver (){}
 		
 		//public funcitons
@@ -107,6 +109,14 @@ class MainSolver : public CARSolver
 		int init_flag_, dead_flag_;
 		
 		Model* model_;
+		std::vector<char> polarities_;  //of the gates encoded, empty for the full encoding
+		
+		//lazy loading: the variables whose definitions are loaded, and those to load
+		std::vector<char> loaded_;
+		std::vector<int> pending_;
+		bool loading_;
+		bool nexts_loaded_;   //whether the cones of all next values are loaded
+		void load (const int id);
 		
 		Statistics* stats_;
 		
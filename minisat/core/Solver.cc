@@ -74,6 +74,7 @@ Solver::Solver() :
     //
   , learntsize_adjust_start_confl (100)
   , learntsize_adjust_inc         (1.5)
+  , export_learnts                (false)
 
     // Statistics: (formerly in 'SolverStats')
     //
@@ -96,6 +97,7 @@ Solver::Solver() :
   , conflict_budget    (-1)
   , propagation_budget (-1)
   , asynch_interrupt   (false)
+  , lbd_stamp_counter  (0)
 {}
 
 
@@ -391,6 +393,23 @@ bool Solver::litRedundant(Lit p, uint32_t abstract_levels)
 }
 
 
+int Solver::computeLBD(const vec<Lit>& c)
+{
+    lbd_stamp_counter++;
+    int lbd = 0;
+    for (int i = 0; i < c.size(); i++){
+        int l = level(var(c[i]));
+        if (l >= lbd_stamp.size())
+            lbd_stamp.growTo(l + 1, 0);
+        if (lbd_stamp[l] != lbd_stamp_counter){
+            lbd_stamp[l] = lbd_stamp_counter;
+            lbd++;
+        }
+    }
+    return lbd;
+}
+
+
 /*_________________________________________________________________________________________________
 |
 |  analyzeFinal : (p : Lit)  ->  [void]
@@ -632,6 +651,8 @@ lbool Solver::search(int nof_conflicts)
 
             learnt_clause.clear();
             analyze(confl, learnt_clause, backtrack_level);
+            if (export_learnts)
+                learntCallback(learnt_clause, computeLBD(learnt_clause));
             cancelUntil(backtrack_level);
 
             if (learnt_clause.size() == 1){
@@ -23,18 +23,25 @@
 
 #include "model.h"
 #include "utility.h"
+#include "minisat/simp/SimpSolver.h"
 #include <stdlib.h>
 #include <iostream>
 #include <assert.h>
 #include <vector>
+#include <thread>
+#include <algorithm>
 
 using namespace std;
 
 namespace car{
 
-	Model::Model (aiger* aig, const bool verbose)
+	Model::Model (aiger* aig, const bool verbose, const bool pg, const bool nary, const bool lazy, const bool simp)
 	{
 	    verbose_ = verbose;
+	    pg_ = pg;
+	    nary_ = nary;
+	    lazy_ = lazy;
+	    simp_ = simp;
 	//According to aiger format, inputs should be [1 ... num_inputs_]
 	//and latches should be [num_inputs+1 ... num_latches+num_inputs]]
 		num_inputs_ = aig->num_inputs;
@@ -56,7 +63,14 @@ namespace car{
 		set_init (aig);
 		
 		create_next_map (aig);
+		if (nary_)
+			collect_absorbed (aig);
 		create_clauses (aig);
+		//built here since the solvers of -pprop load the gates from several threads
+		if (lazy_)
+			index_definitions ();
+		if (simp_)
+			simplify ();
 	}
 	
 	void Model::collect_trues (const aiger* aig)
@@ -123,131 +137,300 @@ namespace car{
 	{
 	    //contraints, outputs and latches gates are stored in order, 
 	    //as the need for start solver construction
-	    hash_set<unsigned> exist_gates;
-		vector<unsigned> gates;
-		gates.resize (max_id_+1, 0);
+	    //section_[v] is the part (1, 2 or 3) the gate of aiger variable v is first needed in, 0 if none
+		section_.assign (aig->maxvar + 1, 0);
+		vector<unsigned> stack;
 		//create clauses for constraints
-		collect_necessary_gates (aig, aig->constraints, aig->num_constraints, exist_gates, gates);
-		
-		for (vector<unsigned>::iterator it = gates.begin (); it != gates.end (); it ++)
-		{
-		    if (*it == 0) continue; 
-			aiger_and* aa = aiger_is_and (const_cast<aiger*>(aig), *it);
-			assert (aa != NULL);
-			add_clauses_from_gate (aa);
-		}
-		
+		collect_necessary_gates (aig, aig->constraints, aig->num_constraints, 1, stack);
+		add_clauses_of_section (aig, 1);
 		
 		set_outputs_start ();
 		
 		//create clauses for outputs
-		gates.resize (max_id_+1, 0);
-		collect_necessary_gates (aig, aig->outputs, aig->num_outputs, exist_gates, gates);
-		
-		for (vector<unsigned>::iterator it = gates.begin (); it != gates.end (); it ++)
-		{
-		    if (*it == 0) continue;
-			aiger_and* aa = aiger_is_and (const_cast<aiger*>(aig), *it);
-			assert (aa != NULL);
-			add_clauses_from_gate (aa);
-		}
+		collect_necessary_gates (aig, aig->outputs, aig->num_outputs, 2, stack);
+		add_clauses_of_section (aig, 2);
 		
 		set_latches_start ();
 		
 		//create clauses for latches
-		gates.resize (max_id_+1, 0);
-		collect_necessary_gates (aig, aig->latches, aig->num_latches, exist_gates, gates, true);
-		for (vector<unsigned>::iterator it = gates.begin (); it != gates.end (); it ++)
+		collect_necessary_gates (aig, aig->latches, aig->num_latches, 3, stack, true);
+		add_clauses_of_section (aig, 3);
+		
+		//the and gates are in topological order after reencoding
+		for (int i = 0; i < aig->num_ands; i ++)
 		{
-		    if (*it == 0) continue;
-			aiger_and* aa = aiger_is_and (const_cast<aiger*>(aig), *it);
-			assert (aa != NULL);
-			add_clauses_from_gate (aa);
+			aiger_and* aa = aig->ands + i;
+			if (section_[aa->lhs >> 1] == 0)
+				continue;
+			Gate g;
+			g.lhs = car_var (aa->lhs);
+			g.rhs0 = car_lit (aa->rhs0);
+			g.rhs1 = car_lit (aa->rhs1);
+			gates_.push_back (g);
 		}
+		section_.clear ();
 		
 		//create clauses for true and false
-		cls_.push_back (clause (true_));
-		cls_.push_back (clause (-false_));
+		cls_.push (true_);
+		cls_.push (-false_);
 		
 		//cout<<"constraint size: "<<constraints_.size()<<endl;
 		for(int i=0;i<constraints_.size();i++){
-			cls_.push_back(clause(constraints_[i]));
+			cls_.push (constraints_[i]);
 			//cout<<"constraint: "<<constraints_[i]<<endl;
 		}
 	}
 	
-	
+	//mark the gates in the cones of \@ as (their next values if \@ next) not marked yet with \@ section,
+	//by a depth-first search on the explicit \@ stack
 	void Model::collect_necessary_gates (const aiger* aig, const aiger_symbol* as, const int as_size, 
-	                                        hash_set<unsigned>& exist_gates, vector<unsigned>& gates, bool next)
+	                                        const char section, vector<unsigned>& stack, bool next)
 	{
 		for (int i = 0; i < as_size; i ++)
 		{
-			aiger_and* aa;
-			if (next) 
-			    aa = necessary_gate (as[i].next, aig);
-			else
-			{
-			    aa = necessary_gate (as[i].lit, aig);
-			    if (aa == NULL)
-			    {
-			    	if (is_true (as[i].lit))
-			    		outputs_[i] = true_;
-			    	else if (is_false (as[i].lit))
-			    		outputs_[i] = false_;
-			    }
-			}
-			recursively_add (aa, aig, exist_gates, gates);	
+			unsigned id = next ? as[i].next : as[i].lit;
+			if (!next && as == aig->outputs && (is_true (id) || is_false (id)))
+				outputs_[i] = is_true (id) ? true_ : false_;
+			stack.push_back (id);
 		}
 		
+		while (!stack.empty ())
+		{
+			unsigned id = stack.back ();
+			stack.pop_back ();
+			if (is_true (id) || is_false (id) || section_[id >> 1] != 0)
+				continue;
+			aiger_and* aa = aiger_is_and (const_cast<aiger*> (aig), id & ~1u);
+			if (aa == NULL)
+				continue;
+			section_[id >> 1] = section;
+			stack.push_back (aa->rhs1);
+			stack.push_back (aa->rhs0);
+		}
 	}
 	
+	//The clauses of the gates marked with \@ section, in the order of the variables. Gates are encoded
+	//independently, so large sections are split over threads and the results joined in order.
+	void Model::add_clauses_of_section (const aiger* aig, const char section)
+	{
+		vector<const aiger_and*> ands;
+		for (int i = 0; i < aig->num_ands; i ++)
+		{
+			if (section_[aig->ands[i].lhs >> 1] == section)
+				ands.push_back (aig->ands + i);
+		}
+		
+		int num_threads = std::thread::hardware_concurrency ();
+		if (num_threads > int (ands.size () / MODEL_GATES_PER_THREAD))
+			num_threads = ands.size () / MODEL_GATES_PER_THREAD;
+		if (num_threads <= 1)
+		{
+			for (int i = 0; i < ands.size (); i ++)
+				add_clauses_from_gate (ands[i], aig, cls_, cls_gates_);
+			return;
+		}
+		
+		vector<ClauseArena> cls (num_threads);
+		vector<vector<int> > tags (num_threads);
+		vector<std::thread> threads;
+		int chunk = (ands.size () + num_threads - 1) / num_threads;
+		for (int t = 0; t < num_threads; t ++)
+		{
+			threads.push_back (std::thread ([&, t] () {
+				int end = std::min (int (ands.size ()), (t + 1) * chunk);
+				for (int i = t * chunk; i < end; i ++)
+					add_clauses_from_gate (ands[i], aig, cls[t], tags[t]);
+			}));
+		}
+		for (int t = 0; t < num_threads; t ++)
+		{
+			threads[t].join ();
+			cls_.append (cls[t]);
+			cls_gates_.insert (cls_gates_.end (), tags[t].begin (), tags[t].end ());
+		}
+	}
 	
-	aiger_and* Model::necessary_gate (const unsigned id, const aiger* aig)
+	void Model::collect_absorbed (const aiger* aig)
 	{
-		if (!is_true (id) && !is_false (id))
-			return aiger_is_and (const_cast<aiger*> (aig), (id % 2 == 0) ? id : (id-1));
-			
-		return NULL;
+		//references of the and gates, and those being a positive input of an and gate
+		vector<int> refs (aig->maxvar + 1, 0), and_refs (aig->maxvar + 1, 0);
+		for (int i = 0; i < aig->num_ands; i ++)
+		{
+			aiger_and& aa = aig->ands[i];
+			refs[aa.rhs0 >> 1] ++;
+			refs[aa.rhs1 >> 1] ++;
+			if ((aa.rhs0 & 1) == 0)
+				and_refs[aa.rhs0 >> 1] ++;
+			if ((aa.rhs1 & 1) == 0)
+				and_refs[aa.rhs1 >> 1] ++;
+		}
+		for (int i = 0; i < aig->num_latches; i ++)
+			refs[aig->latches[i].next >> 1] ++;
+		for (int i = 0; i < aig->num_outputs; i ++)
+			refs[aig->outputs[i].lit >> 1] ++;
+		for (int i = 0; i < aig->num_constraints; i ++)
+			refs[aig->constraints[i].lit >> 1] ++;
+		
+		absorbed_.resize (aig->maxvar + 1, 0);
+		for (int i = 0; i < aig->num_ands; i ++)
+		{
+			unsigned var = aig->ands[i].lhs >> 1;
+			absorbed_[var] = (refs[var] == 1 && and_refs[var] == 1);
+		}
 	}
 	
-	void Model::recursively_add (const aiger_and* aa, const aiger* aig, hash_set<unsigned>& exist_gates, vector<unsigned>& gates)
+	//the inputs of the n-ary and gate rooted at \@ id, through the absorbed gates
+	void Model::collect_leaves (const unsigned id, const aiger* aig, vect& leaves)
 	{
-		if (aa == NULL)
-			return;
-		if (exist_gates.find (aa->lhs) != exist_gates.end ())
+		vector<unsigned> stack (1, id);
+		while (!stack.empty ())
+		{
+			unsigned lit = stack.back ();
+			stack.pop_back ();
+			if (is_true (lit))
+				continue;
+			if ((lit & 1) == 0 && !absorbed_.empty () && absorbed_[lit >> 1])
+			{
+				aiger_and* aa = aiger_is_and (const_cast<aiger*> (aig), lit);
+				assert (aa != NULL);
+				stack.push_back (aa->rhs1);
+				stack.push_back (aa->rhs0);
+			}
+			else
+				leaves.push_back (car_var (lit));
+		}
+	}
+	
+	void Model::add_clauses_from_gate (const aiger_and* aa, const aiger* aig, ClauseArena& cls, vector<int>& tags)
+	{
+		assert (aa != NULL);
+		assert (!is_true (aa->lhs) && !is_false (aa->lhs));
+		//encoded in the gate reading it
+		if (!absorbed_.empty () && absorbed_[aa->lhs >> 1])
 			return;
 		
-		gates[aa->lhs/2] = aa->lhs;
-		exist_gates.insert (aa->lhs);
-		aiger_and* aa0 = necessary_gate (aa->rhs0, aig);
-		recursively_add (aa0, aig, exist_gates, gates);
+		vect leaves;
+		collect_leaves (aa->rhs0, aig, leaves);
+		collect_leaves (aa->rhs1, aig, leaves);
 		
-		aiger_and* aa1 = necessary_gate (aa->rhs1, aig);
-		recursively_add (aa1, aig, exist_gates, gates);
+		int lhs = car_var (aa->lhs);
+		cls.add (lhs);
+		for (int i = 0; i < leaves.size (); i ++)
+			cls.add (-leaves[i]);
+		cls.close ();
+		tags.push_back (-lhs);
+		for (int i = 0; i < leaves.size (); i ++)
+		{
+			cls.push (-lhs, leaves[i]);
+			tags.push_back (lhs);
+		}
 	}
 	
-	void Model::add_clauses_from_gate (const aiger_and* aa)
+	void Model::polarities (const vector<int>& roots, const bool nexts, vector<char>& pol)
 	{
-		assert (aa != NULL);
-		assert (!is_true (aa->lhs) && !is_false (aa->lhs));
+		pol.clear ();
+		if (!pg_)
+			return;
+		pol.resize (max_id_ + 1, 0);
+		for (int i = 0; i < roots.size (); i ++)
+			pol[abs (roots[i])] |= (roots[i] > 0) ? POS_POLARITY : NEG_POLARITY;
+		for (int i = 0; i < constraints_.size (); i ++)
+			pol[abs (constraints_[i])] |= (constraints_[i] > 0) ? POS_POLARITY : NEG_POLARITY;
+		if (nexts)
+		{
+			for (nextMap::iterator it = next_map_.begin (); it != next_map_.end (); it ++)
+				pol[abs (it->second)] = POS_POLARITY | NEG_POLARITY;
+		}
 		
-		if (is_true (aa->rhs0))
+		//gates_ is in topological order, so the polarities of a gate are complete before its inputs
+		for (int i = gates_.size () - 1; i >= 0; i --)
 		{
-			cls_.push_back (clause (car_var (aa->lhs), -car_var (aa->rhs1)));
-			cls_.push_back (clause (-car_var (aa->lhs), car_var (aa->rhs1)));
+			Gate& g = gates_[i];
+			char p = pol[g.lhs];
+			if (p == 0)
+				continue;
+			//a negated input is used in the opposite polarities
+			char q = ((p & POS_POLARITY) ? NEG_POLARITY : 0) | ((p & NEG_POLARITY) ? POS_POLARITY : 0);
+			pol[abs (g.rhs0)] |= (g.rhs0 > 0) ? p : q;
+			pol[abs (g.rhs1)] |= (g.rhs1 > 0) ? p : q;
 		}
-		else if (is_true (aa->rhs1))
+	}
+	
+	void Model::index_definitions ()
+	{
+		defs_.resize (max_id_ + 1);
+		for (int i = 0; i < cls_gates_.size (); i ++)
 		{
-			cls_.push_back (clause (car_var (aa->lhs), -car_var (aa->rhs0)));
-			cls_.push_back (clause (-car_var (aa->lhs), car_var (aa->rhs0)));
+			if (cls_gates_[i] != 0)
+				defs_[abs (cls_gates_[i])].push_back (i);
 		}
-		else
+	}
+	
+	//SimpSolver keeps its clause database protected
+	class ModelSimplifier : public Minisat::SimpSolver
+	{
+	public:
+		//the remaining clauses and the units fixed at level 0, in ids (variable + 1)
+		void export_clauses (ClauseArena& res)
 		{
-			cls_.push_back (clause (car_var (aa->lhs), -car_var (aa->rhs0), -car_var (aa->rhs1)));
-			cls_.push_back (clause (-car_var (aa->lhs), car_var (aa->rhs0)));
-			cls_.push_back (clause (-car_var (aa->lhs), car_var (aa->rhs1)));
+			using namespace Minisat;
+			if (!okay ())
+			{
+				res.close ();
+				return;
+			}
+			for (int i = 0; i < nVars (); i ++)
+			{
+				if (value (i) != l_Undef)
+					res.push ((value (i) == l_True) ? (i+1) : -(i+1));
+			}
+			for (int i = 0; i < clauses.size (); i ++)
+			{
+				Minisat::Clause& c = ca[clauses[i]];
+				if (c.mark () != 0 || satisfied (c))
+					continue;
+				for (int j = 0; j < c.size (); j ++)
+				{
+					if (value (c[j]) != l_False)
+						res.add (sign (c[j]) ? -(var (c[j])+1) : (var (c[j])+1));
+				}
+				res.close ();
+			}
 		}
-			
+	};
+	
+	//Bounded variable elimination and subsumption on cls_, with all the variables other solvers or
+	//the checker may assume or read frozen: inputs, latches, next values, outputs, constraints and constants.
+	//The result is equisatisfiable for every assignment of them.
+	void Model::simplify ()
+	{
+		ModelSimplifier solver;
+		while (solver.nVars () < max_id_)
+			solver.newVar ();
+		for (int i = 1; i <= num_inputs_ + num_latches_; i ++)
+			solver.setFrozen (i-1, true);
+		for (nextMap::iterator it = next_map_.begin (); it != next_map_.end (); it ++)
+			solver.setFrozen (abs (it->second)-1, true);
+		for (int i = 0; i < outputs_.size (); i ++)
+			solver.setFrozen (abs (outputs_[i])-1, true);
+		for (int i = 0; i < constraints_.size (); i ++)
+			solver.setFrozen (abs (constraints_[i])-1, true);
+		solver.setFrozen (true_-1, true);
+		solver.setFrozen (false_-1, true);
+		
+		Minisat::vec<Minisat::Lit> lits;
+		for (int i = 0; i < cls_.size (); i ++)
+		{
+			const int* cl = cls_.clause (i);
+			lits.clear ();
+			for (int j = 0; j < cls_.clause_size (i); j ++)
+				lits.push (Minisat::mkLit (abs (cl[j])-1, cl[j] < 0));
+			if (!solver.addClause_ (lits))
+				break;
+		}
+		if (solver.okay ())
+			solver.eliminate (true);
+		solver.export_clauses (simp_cls_);
 	}
 	
 	void Model::set_init (const aiger* aig)
@@ -268,10 +451,12 @@ namespace car{
 	
 	void Model::set_constraints (const aiger* aig)
 	{
+		//a TRUE constraint is dropped, and a FALSE one is encoded by false_, so that no state meets it
 		for (int i = 0; i < aig->num_constraints; i ++)
 		{
-			int id = (int) aig->constraints[i].lit;
-			constraints_.push_back ((id%2 == 0) ? (id/2) : -(id/2));
+			unsigned id = aig->constraints[i].lit;
+			if (!is_true (id))
+				constraints_.push_back (car_lit (id));
 		}
 	}
 	
@@ -354,10 +539,11 @@ namespace car{
 	    }
 	    
 	    for (int i = 0; i < cls_.size (); i ++) {
-	        Clause& cl = cls_[i];
+	        const int* cl = cls_.clause (i);
+	        int cl_size = cls_.clause_size (i);
 	        vector<int> tmp;
 	        int j = 0;
-	        for (; j < cl.size (); j ++) {
+	        for (; j < cl_size; j ++) {
 	            if (is_true (cl[j]) || res[abs (cl[j])] == cl[j]) {
 	                tmp.clear ();
 	                break;
@@ -366,7 +552,7 @@ namespace car{
 	                continue;
 	            tmp.push_back (cl[j]);
 	        }
-	        if (j >= cl.size ()) {
+	        if (j >= cl_size) {
 	            if (tmp.size () == 1) {
 	                res[abs(tmp[0])] = tmp[0]; 
 	            }
@@ -383,8 +569,10 @@ namespace car{
 	{
 	    cout << "-------------------Model information--------------------" << endl;
 	    cout << endl << "number of clauses: " << cls_.size () << endl;
+	    if (simp_)
+	    	cout << "number of clauses after simplification: " << simp_cls_.size () << endl;
 	    for (int i  = 0; i < cls_.size (); i ++)
-	        car::print (cls_[i]);
+	        car::print (vector<int> (cls_.clause (i), cls_.clause (i) + cls_.clause_size (i)));
 	    cout << endl << "next map: " << endl;
 	    car::print (next_map_);
 	    cout << endl << "reverse next map:" << endl;
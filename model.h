@@ -31,11 +31,22 @@ extern "C" {
 #include "assert.h"
 #include "hash_set.h"
 #include "data_structure.h"
+#include "clausearena.h"
+
+#define MODEL_GATES_PER_THREAD 50000  //clause generation of fewer gates is not split over threads
 
 namespace car {
+//and gate lhs <-> rhs0 /\ rhs1, in the ids of the model
+struct Gate {
+	int lhs, rhs0, rhs1;
+};
+
 class Model {
 public:
-	Model (aiger*, const bool verbose = false);
+	//polarities a gate is used in, for the Plaisted-Greenbaum encoding
+	enum {POS_POLARITY = 1, NEG_POLARITY = 2};
+	
+	Model (aiger*, const bool verbose = false, const bool pg = false, const bool nary = false, const bool lazy = false, const bool simp = false);
 	~Model () {}
 	
 	int prime (const int);
@@ -53,9 +64,39 @@ public:
 	inline int outputs_start () {return outputs_start_;}
 	inline int latches_start () {return latches_start_;}
 	inline int size () {return cls_.size ();}
-	inline std::vector<int>& element (const int id) {return cls_[id];}
+	inline ClauseArena& clauses () {return cls_;}
 	inline int output (const int id) {return outputs_[id];}
-	
+	inline std::vector<int>& constraints () {return constraints_;}
+	inline std::vector<Gate>& gates () {return gates_;}
+	
+	//The polarities \@ pol (indexed by ids) of the gates, for a solver asserting or assuming the literals in \@ roots
+	//(in their signs), the constraints and, if \@ nexts, the next values of latches in both polarities.
+	//\@ pol is left empty for the full encoding.
+	void polarities (const std::vector<int>& roots, const bool nexts, std::vector<char>& pol);
+	//whether clause \@ i is needed by a solver with polarities \@ pol
+	inline bool needed (const int i, const std::vector<char>& pol) {
+		int g = (i < cls_gates_.size ()) ? cls_gates_[i] : 0;
+		if (pol.empty () || g == 0)
+			return true;
+		return (g > 0) ? (pol[g] & POS_POLARITY) : (pol[-g] & NEG_POLARITY);
+	}
+	//the gate clause \@ i is in the definition of, 0 for other clauses
+	inline int gate_of_clause (const int i) {return (i < cls_gates_.size ()) ? abs (cls_gates_[i]) : 0;}
+	//indices of the clauses in the definition of the gate \@ id
+	inline std::vector<int>& definition (const int id) {return defs_[id];}
+	//whether the solvers load the clauses of a gate only once it is referenced
+	inline bool lazy () {return lazy_;}
+	
+	//the clauses after variable elimination and subsumption, in place of all those in cls_ for the main solvers
+	inline bool simplified () {return simp_;}
+	inline ClauseArena& simp_clauses () {return simp_cls_;}
+	
+	//whether assuming \@ id is sound under \@ pol
+	inline bool encoded (const int id, const std::vector<char>& pol) {
+		if (pol.empty () || state_var (abs (id)) || abs (id) >= true_)
+			return true;
+		return pol[abs (id)] & ((id > 0) ? POS_POLARITY : NEG_POLARITY);
+	}	
 	inline Cube& init () {return init_;}
 	
 	void shrink_to_previous_vars (Cube& cu, bool& constraint);
@@ -71,6 +112,10 @@ public:
 private:
 	//members
 	bool verbose_;
+	bool pg_;   //encode the gates only in the polarities they are used in
+	bool nary_; //encode single-fanout and trees as one n-ary and gate
+	bool lazy_; //load the gate clauses into the solvers on demand
+	bool simp_; //simplify cls_ by SatELite for the main solvers
 		
 	int num_inputs_;
 	int num_latches_;
@@ -84,16 +129,21 @@ private:
 	int false_;  //id for false
 	
 	typedef std::vector<int> vect;
-	typedef std::vector<vect> Clauses;
 	
 	vect init_;   //initial state
 	vect outputs_; //output ids
 	vect constraints_; //constraint ids
-	Clauses cls_;  //set of clauses, it contains three parts:
+	std::vector<Gate> gates_; //gates encoded in cls_, in topological order
+	std::vector<int> cls_gates_;  //the gate each clause of cls_ defines: lhs for lhs -> rhs0 /\ rhs1,
+	                              //-lhs for rhs0 /\ rhs1 -> lhs, and 0 for the others
+	std::vector<std::vector<int> > defs_;  //clauses of each gate, by index in cls_, only built with lazy_
+	ClauseArena cls_;  //set of clauses, it contains three parts:
 	                //(1) clauses for constraints, i.e. those before position outputs_start_;
 	                //(2) clauses for outputs, i.e. those before position latches_start_;
 	                //(3) clauses for latches, i.e. all 
 	
+	ClauseArena simp_cls_;  //cls_ simplified with the interface variables frozen
+	
 	int outputs_start_; //the index of cls_ to point the start position of outputs
 	int latches_start_; //the index of cls_ to point the start position of latches
 	
@@ -104,6 +154,8 @@ private:
 	                                   //BE careful the situation when next (a) = c and next (b) = c!!
 	
 	hash_set<unsigned> trues_;  //vars evaluated to be true, and their negation is false
+	std::vector<char> section_;   //the part of cls_ each and gate (by aiger vars) is encoded in, during construction
+	std::vector<char> absorbed_;  //and gates (by aiger vars) only read positively by one and gate, which encodes them
 	
 	
 	//functions
@@ -123,28 +175,14 @@ private:
 		return ((id % 2 == 0) ? (id/2) : -(id/2));
 	}
 	
-	inline vect clause (int id)
-	{
-		vect res;
-		res.push_back (id);
-		return res;
-	}
-	
-	inline vect clause (int id1, int id2)
-	{
-		vect res;
-		res.push_back (id1);
-		res.push_back (id2);
-		return res;
-	}
-	
-	inline vect clause (int id1, int id2, int id3)
+	//car_var with constants mapped to true_ and false_
+	inline int car_lit (const unsigned id)
 	{
-		vect res;
-		res.push_back (id1);
-		res.push_back (id2);
-		res.push_back (id3); 
-		return res;
+		if (is_true (id))
+			return true_;
+		if (is_false (id))
+			return false_;
+		return car_var (id);
 	}
 	
 	inline void set_outputs_start ()
@@ -160,10 +198,13 @@ private:
 	void collect_trues (const aiger* aig);
 	void create_next_map (const aiger* aig);
 	void create_clauses (const aiger* aig);
-	void collect_necessary_gates (const aiger* aig, const aiger_symbol* as, const int as_size, hash_set<unsigned>& exist_gates, std::vector<unsigned>& gates, bool next = false);
-	aiger_and* necessary_gate (const unsigned id, const aiger* aig);
-	void recursively_add (const aiger_and* aa, const aiger* aig, hash_set<unsigned>& exist_gates, std::vector<unsigned>& gates);
-	void add_clauses_from_gate (const aiger_and* aa);
+	void collect_necessary_gates (const aiger* aig, const aiger_symbol* as, const int as_size, const char section, std::vector<unsigned>& stack, bool next = false);
+	void add_clauses_of_section (const aiger* aig, const char section);
+	void collect_absorbed (const aiger* aig);
+	void index_definitions ();
+	void simplify ();
+	void collect_leaves (const unsigned id, const aiger* aig, vect& leaves);
+	void add_clauses_from_gate (const aiger_and* aa, const aiger* aig, ClauseArena& cls, std::vector<int>& tags);
 	void set_init (const aiger* aig);
 	void set_constraints (const aiger* aig);
 	void set_outputs (const aiger* aig);
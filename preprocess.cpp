@@ -0,0 +1,731 @@
+/*
+    Copyright (C) 2018, Jianwen Li (lijwen2748@gmail.com), Iowa State University
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+	Author: Jianwen Li
+	Update Date: October 19, 2026
+	Preprocessing of the aiger model before it is encoded by Model
+*/
+
+#include "preprocess.h"
+#include "carsolver.h"
+#include <map>
+#include <queue>
+#include <algorithm>
+#include <iostream>
+#include <stdint.h>
+#include <assert.h>
+using namespace std;
+
+namespace car
+{
+	//the solver id of an aiger literal, var 0 (FALSE) takes id 1
+	static inline int solver_id (const unsigned lit)
+	{
+		int id = int (lit >> 1) + 1;
+		return (lit & 1) ? -id : id;
+	}
+	
+	//random values for inputs and latches, and the and gates evaluated in order
+	static void simulate (aiger* aig, vector<uint64_t>& sig)
+	{
+		sig.assign ((aig->maxvar + 1) * FRAIG_WORDS, 0);
+		uint64_t rng = 0x9E3779B97F4A7C15ULL;
+		for (unsigned v = 1; v <= aig->num_inputs + aig->num_latches; v ++)
+		{
+			for (int w = 0; w < FRAIG_WORDS; w ++)
+			{
+				rng ^= rng >> 12;
+				rng ^= rng << 25;
+				rng ^= rng >> 27;
+				sig[v * FRAIG_WORDS + w] = rng * 2685821657736338717ULL;
+			}
+		}
+		for (unsigned i = 0; i < aig->num_ands; i ++)
+		{
+			aiger_and& aa = aig->ands[i];
+			uint64_t m0 = (aa.rhs0 & 1) ? ~uint64_t (0) : 0;
+			uint64_t m1 = (aa.rhs1 & 1) ? ~uint64_t (0) : 0;
+			for (int w = 0; w < FRAIG_WORDS; w ++)
+				sig[(aa.lhs >> 1) * FRAIG_WORDS + w] = (sig[(aa.rhs0 >> 1) * FRAIG_WORDS + w] ^ m0) & (sig[(aa.rhs1 >> 1) * FRAIG_WORDS + w] ^ m1);
+		}
+	}
+	
+	//a and b are equivalent iff both a /\ -b and -a /\ b are UNSAT, false if not proved within the budget
+	static bool equivalent (CARSolver& solver, const int a, const int b)
+	{
+		for (int k = 0; k < 2; k ++)
+		{
+			solver.clear_assumption ();
+			solver.assumption_push (k == 0 ? a : -a);
+			solver.assumption_push (k == 0 ? -b : b);
+			if (solver.solve_assumption (FRAIG_CONFLICTS) != 0)
+				return false;
+		}
+		return true;
+	}
+	
+	aiger* fraig (aiger* aig, const bool verbose)
+	{
+		vector<uint64_t> sig;
+		simulate (aig, sig);
+		
+		CARSolver solver;
+		solver.add_clause (-solver_id (0));
+		for (unsigned i = 0; i < aig->num_ands; i ++)
+		{
+			aiger_and& aa = aig->ands[i];
+			solver.add_equivalence (solver_id (aa.lhs), solver_id (aa.rhs0), solver_id (aa.rhs1));
+		}
+		
+		vector<unsigned> repr (aig->maxvar + 1);
+		for (unsigned v = 0; v <= aig->maxvar; v ++)
+			repr[v] = 2 * v;
+		
+		//classes by the signatures normalized to have the first bit 0, mapped to their first gate,
+		//and FALSE is the first of the all-zero class
+		map<vector<uint64_t>, unsigned> classes;
+		classes[vector<uint64_t> (FRAIG_WORDS, 0)] = 0;
+		int calls = 0, merged = 0;
+		for (unsigned i = 0; i < aig->num_ands; i ++)
+		{
+			unsigned v = aig->ands[i].lhs >> 1;
+			vector<uint64_t> s (sig.begin () + v * FRAIG_WORDS, sig.begin () + (v + 1) * FRAIG_WORDS);
+			unsigned phase = s[0] & 1;
+			if (phase)
+			{
+				for (int w = 0; w < FRAIG_WORDS; w ++)
+					s[w] = ~s[w];
+			}
+			map<vector<uint64_t>, unsigned>::iterator it = classes.find (s);
+			if (it == classes.end ())
+			{
+				classes[s] = v;
+				continue;
+			}
+			if (calls >= FRAIG_MAX_CALLS)
+				continue;
+			calls ++;
+			unsigned r = it->second;
+			unsigned lit = 2 * r + ((sig[r * FRAIG_WORDS] & 1) ^ phase);
+			if (equivalent (solver, solver_id (2 * v), solver_id (lit)))
+			{
+				repr[v] = lit;
+				//help the later checks
+				solver.add_equivalence (solver_id (2 * v), solver_id (lit));
+				merged ++;
+			}
+		}
+		
+		if (verbose)
+			cout << "fraig: " << merged << " of " << aig->num_ands << " and gates merged with " << calls << " checks" << endl;
+		return rebuild (aig, repr);
+	}
+	
+	static aiger* strash (aiger* aig)
+	{
+		AigBuilder builder (aig);
+		for (unsigned i = 0; i < aig->num_ands; i ++)
+		{
+			aiger_and& aa = aig->ands[i];
+			builder.set (aa.lhs >> 1, builder.add_and (builder.lit (aa.rhs0), builder.lit (aa.rhs1)));
+		}
+		return builder.finish ();
+	}
+	
+	//ternary value of \@ lit, 0, 1, or 2 for X
+	static inline char value (const vector<char>& vals, const unsigned lit)
+	{
+		char v = vals[lit >> 1];
+		return (v == 2 || !(lit & 1)) ? v : 1 - v;
+	}
+	
+	//Latches start stuck at their reset values, and are released if their next values are not the same
+	//by ternary simulation with the stuck ones at reset, until a fixpoint. The stuck ones are then
+	//replaced by constants, which holds by induction from the initial state.
+	static aiger* propagate_constants (aiger* aig, int& num_stuck)
+	{
+		vector<char> stuck (aig->num_latches);
+		for (unsigned i = 0; i < aig->num_latches; i ++)
+			stuck[i] = aig->latches[i].reset <= 1;
+		
+		vector<char> vals (aig->maxvar + 1, 2);
+		vals[0] = 0;
+		bool changed = true;
+		while (changed)
+		{
+			changed = false;
+			for (unsigned i = 0; i < aig->num_latches; i ++)
+				vals[aig->latches[i].lit >> 1] = stuck[i] ? aig->latches[i].reset : 2;
+			for (unsigned i = 0; i < aig->num_ands; i ++)
+			{
+				aiger_and& aa = aig->ands[i];
+				char v0 = value (vals, aa.rhs0), v1 = value (vals, aa.rhs1);
+				vals[aa.lhs >> 1] = (v0 == 0 || v1 == 0) ? 0 : ((v0 == 1 && v1 == 1) ? 1 : 2);
+			}
+			for (unsigned i = 0; i < aig->num_latches; i ++)
+			{
+				if (stuck[i] && value (vals, aig->latches[i].next) != aig->latches[i].reset)
+				{
+					stuck[i] = false;
+					changed = true;
+				}
+			}
+		}
+		
+		AigBuilder builder (aig);
+		num_stuck = 0;
+		for (unsigned i = 0; i < aig->num_latches; i ++)
+		{
+			if (stuck[i])
+			{
+				builder.set (aig->latches[i].lit >> 1, aig->latches[i].reset);
+				num_stuck ++;
+			}
+		}
+		for (unsigned i = 0; i < aig->num_ands; i ++)
+		{
+			aiger_and& aa = aig->ands[i];
+			builder.set (aa.lhs >> 1, builder.add_and (builder.lit (aa.rhs0), builder.lit (aa.rhs1)));
+		}
+		return builder.finish ();
+	}
+	
+	//A gate only used once, as a positive fanin of another gate, is absorbed in the and tree of that gate.
+	//The leaves of each tree are then conjoined in a balanced way, the two of the lowest levels first.
+	static aiger* balance (aiger* aig)
+	{
+		unsigned first_and = aig->num_inputs + aig->num_latches + 1;
+		vector<int> refs (aig->maxvar + 1, 0), pos_refs (aig->maxvar + 1, 0);
+		for (unsigned i = 0; i < aig->num_ands; i ++)
+		{
+			aiger_and& aa = aig->ands[i];
+			refs[aa.rhs0 >> 1] ++;
+			refs[aa.rhs1 >> 1] ++;
+			if (!(aa.rhs0 & 1))
+				pos_refs[aa.rhs0 >> 1] ++;
+			if (!(aa.rhs1 & 1))
+				pos_refs[aa.rhs1 >> 1] ++;
+		}
+		for (unsigned i = 0; i < aig->num_latches; i ++)
+			refs[aig->latches[i].next >> 1] ++;
+		for (unsigned i = 0; i < aig->num_outputs; i ++)
+			refs[aig->outputs[i].lit >> 1] ++;
+		for (unsigned i = 0; i < aig->num_bad; i ++)
+			refs[aig->bad[i].lit >> 1] ++;
+		for (unsigned i = 0; i < aig->num_constraints; i ++)
+			refs[aig->constraints[i].lit >> 1] ++;
+		
+		AigBuilder builder (aig);
+		typedef pair<int, unsigned> Leaf;  //level and literal
+		for (unsigned i = 0; i < aig->num_ands; i ++)
+		{
+			aiger_and& aa = aig->ands[i];
+			unsigned v = aa.lhs >> 1;
+			if (refs[v] == 1 && pos_refs[v] == 1)
+				continue;
+			
+			priority_queue<Leaf, vector<Leaf>, greater<Leaf> > leaves;
+			vector<unsigned> stack;
+			stack.push_back (aa.rhs0);
+			stack.push_back (aa.rhs1);
+			while (!stack.empty ())
+			{
+				unsigned l = stack.back ();
+				stack.pop_back ();
+				unsigned u = l >> 1;
+				if (!(l & 1) && u >= first_and && refs[u] == 1 && pos_refs[u] == 1)
+				{
+					aiger_and* child = aiger_is_and (aig, l);
+					stack.push_back (child->rhs0);
+					stack.push_back (child->rhs1);
+				}
+				else
+					leaves.push (Leaf (builder.level (builder.lit (l)), builder.lit (l)));
+			}
+			while (leaves.size () > 1)
+			{
+				unsigned a = leaves.top ().second;
+				leaves.pop ();
+				unsigned b = leaves.top ().second;
+				leaves.pop ();
+				unsigned c = builder.add_and (a, b);
+				leaves.push (Leaf (builder.level (c), c));
+			}
+			builder.set (v, leaves.top ().second);
+		}
+		return builder.finish ();
+	}
+	
+	static int depth (aiger* aig)
+	{
+		vector<int> levels (aig->maxvar + 1, 0);
+		int res = 0;
+		for (unsigned i = 0; i < aig->num_ands; i ++)
+		{
+			aiger_and& aa = aig->ands[i];
+			levels[aa.lhs >> 1] = std::max (levels[aa.rhs0 >> 1], levels[aa.rhs1 >> 1]) + 1;
+			res = std::max (res, levels[aa.lhs >> 1]);
+		}
+		return res;
+	}
+	
+	aiger* optimize (aiger* aig, const bool verbose)
+	{
+		aiger* hashed = strash (aig);
+		int num_stuck = 0;
+		aiger* propagated = propagate_constants (hashed, num_stuck);
+		aiger_reset (hashed);
+		aiger* res = balance (propagated);
+		aiger_reset (propagated);
+		
+		if (verbose)
+			cout << "optimize: " << aig->num_ands << " -> " << res->num_ands << " and gates, depth " << depth (aig) << " -> " << depth (res) 
+			     << ", " << num_stuck << " latches stuck at reset" << endl;
+		return res;
+	}
+	
+	AigBuilder::AigBuilder (aiger* aig, const bool strash, const vector<char>* removed) : aig_ (aig), strash_ (strash), no_path_ (false)
+	{
+		res_ = aiger_init ();
+		lits_.resize (aig->maxvar + 1, 0);
+		levels_.push_back (0);
+		for (unsigned i = 0; i < aig->num_inputs; i ++)
+		{
+			lits_[aig->inputs[i].lit >> 1] = new_var ();
+			aiger_add_input (res_, lits_[aig->inputs[i].lit >> 1], aig->inputs[i].name);
+		}
+		latch_lits_.resize (aig->num_latches, 0);
+		for (unsigned i = 0; i < aig->num_latches; i ++)
+		{
+			if (removed == NULL || !(*removed)[i])
+				latch_lits_[i] = lits_[aig->latches[i].lit >> 1] = new_var ();
+		}
+	}
+	
+	unsigned AigBuilder::add_and (unsigned a, unsigned b)
+	{
+		if (a > b)
+			std::swap (a, b);
+		if (strash_)
+		{
+			if (a == 0 || a == (b ^ 1))
+				return 0;
+			if (a == 1 || a == b)
+				return b;
+			map<pair<unsigned, unsigned>, unsigned>::iterator it = table_.find (pair<unsigned, unsigned> (a, b));
+			if (it != table_.end ())
+				return it->second;
+		}
+		int level = std::max (levels_[a >> 1], levels_[b >> 1]) + 1;
+		unsigned res = new_var ();
+		levels_.back () = level;
+		aiger_add_and (res_, res, a, b);
+		if (strash_)
+			table_[pair<unsigned, unsigned> (a, b)] = res;
+		return res;
+	}
+	
+	aiger* AigBuilder::finish (const int output)
+	{
+		for (unsigned i = 0; i < aig_->num_latches; i ++)
+		{
+			unsigned lit = latch_lits_[i];
+			if (lit == 0)
+				continue;
+			aiger_symbol& l = aig_->latches[i];
+			aiger_add_latch (res_, lit, this->lit (l.next), l.name);
+			aiger_add_reset (res_, lit, (l.reset == l.lit) ? lit : l.reset);
+		}
+		//a TRUE constraint is dropped, and a FALSE one leaves no valid path, so every property holds
+		for (unsigned i = 0; i < aig_->num_constraints; i ++)
+		{
+			if (lit (aig_->constraints[i].lit) == 0)
+				no_path_ = true;
+		}
+		for (unsigned i = 0; i < aig_->num_outputs; i ++)
+		{
+			if (output == -1 || output == i)
+				aiger_add_output (res_, no_path_ ? 0 : lit (aig_->outputs[i].lit), aig_->outputs[i].name);
+		}
+		for (unsigned i = 0; output == -1 && i < aig_->num_bad; i ++)
+			aiger_add_bad (res_, no_path_ ? 0 : lit (aig_->bad[i].lit), aig_->bad[i].name);
+		for (unsigned i = 0; !no_path_ && i < aig_->num_constraints; i ++)
+		{
+			unsigned l = lit (aig_->constraints[i].lit);
+			if (l != 1)
+				aiger_add_constraint (res_, l, aig_->constraints[i].name);
+		}
+		
+		aiger_reencode (res_);
+		aiger* res = res_;
+		res_ = NULL;
+		return res;
+	}
+	
+	//Candidates of merge_latches: FALSE (var 0) and the latches with a binary reset value, each in a class
+	//with a representative, i.e. its first member. The phase of a candidate is its reset value,
+	//and a candidate c of class r stands for c == r ^ phase (c) ^ phase (r).
+	class LatchClasses
+	{
+	public:
+		LatchClasses (aiger* aig)
+		{
+			vars_.push_back (0);
+			phases_.push_back (0);
+			for (unsigned i = 0; i < aig->num_latches; i ++)
+			{
+				if (aig->latches[i].reset <= 1)
+				{
+					vars_.push_back (aig->latches[i].lit >> 1);
+					phases_.push_back (aig->latches[i].reset);
+				}
+			}
+			classes_.assign (vars_.size (), 0);
+		}
+		
+		inline int size () {return vars_.size ();}
+		inline unsigned var (const int i) {return vars_[i];}
+		inline unsigned phase (const int i) {return phases_[i];}
+		//the candidate index of the representative of candidate i
+		inline int repr (const int i) {return classes_[i];}
+		
+		//Split the classes by the values \@ vals of the candidates (with their phases applied),
+		//return true if any class is split
+		bool refine (const vector<uint64_t>& vals)
+		{
+			map<pair<int, uint64_t>, int> parts;
+			bool res = false;
+			for (int i = 0; i < vars_.size (); i ++)
+			{
+				pair<int, uint64_t> key (classes_[i], vals[i]);
+				map<pair<int, uint64_t>, int>::iterator it = parts.find (key);
+				if (it == parts.end ())
+				{
+					if (classes_[i] != i)
+						res = true;
+					parts[key] = i;
+					classes_[i] = i;
+				}
+				else
+					classes_[i] = it->second;
+			}
+			return res;
+		}
+		
+		//drop candidate \@ i from its class, and the class is split if i is its representative
+		void isolate (const int i)
+		{
+			int first = -1;
+			for (int j = i + 1; j < vars_.size (); j ++)
+			{
+				if (classes_[j] != classes_[i] || classes_[i] != i)
+					continue;
+				if (first == -1)
+					first = j;
+				classes_[j] = first;
+			}
+			classes_[i] = i;
+		}
+		
+		inline bool merged (const int i) {return classes_[i] != i;}
+		
+	private:
+		vector<unsigned> vars_;
+		vector<unsigned> phases_;
+		vector<int> classes_;
+	};
+	
+	//the solver id of \@ lit in copy \@ frame of the model
+	static inline int frame_id (aiger* aig, const int frame, const unsigned lit)
+	{
+		int id = frame * int (aig->maxvar + 1) + int (lit >> 1) + 1;
+		return (lit & 1) ? -id : id;
+	}
+	
+	//the flag of the constraints in copy \@ frame, the flags of checks are above those of all copies
+	static inline int constraint_flag (aiger* aig, const int frame)
+	{
+		return (LATCH_EQ_DEPTH + 1) * int (aig->maxvar + 1) + frame + 1;
+	}
+	
+	//Copies 0 ... \@ frames-1 of the model, each latch in copy f+1 being its next in copy f.
+	//The constraints of copy f hold under constraint_flag (f).
+	static void unroll (CARSolver& solver, aiger* aig, const int frames)
+	{
+		for (int f = 0; f < frames; f ++)
+		{
+			solver.add_clause (-frame_id (aig, f, 0));
+			for (unsigned i = 0; i < aig->num_ands; i ++)
+			{
+				aiger_and& aa = aig->ands[i];
+				solver.add_equivalence (frame_id (aig, f, aa.lhs), frame_id (aig, f, aa.rhs0), frame_id (aig, f, aa.rhs1));
+			}
+			for (unsigned i = 0; i < aig->num_constraints; i ++)
+				solver.add_clause (-constraint_flag (aig, f), frame_id (aig, f, aig->constraints[i].lit));
+			if (f == 0)
+				continue;
+			for (unsigned i = 0; i < aig->num_latches; i ++)
+				solver.add_equivalence (frame_id (aig, f, aig->latches[i].lit), frame_id (aig, f-1, aig->latches[i].next));
+		}
+	}
+	
+	//the literal of candidate i by the representative in copy \@ frame
+	static inline int repr_id (aiger* aig, LatchClasses& classes, const int i, const int frame)
+	{
+		int r = classes.repr (i);
+		return frame_id (aig, frame, 2 * classes.var (r) + (classes.phase (i) ^ classes.phase (r)));
+	}
+	
+	//Check the equivalences of the candidates in copy \@ frame, those in copies [\@ begin, \@ frame) assumed under \@ flag.
+	//The constraints are assumed in the copies before \@ frame only: a state entered by a valid path must meet
+	//the equivalences even if it violates the constraints, or replacing the latches would change the constraints.
+	//Return false after refining \@ classes by a counterexample or dropping a candidate out of budget.
+	static bool check_frame (CARSolver& solver, aiger* aig, LatchClasses& classes, const int begin, const int frame, int& flag)
+	{
+		flag ++;
+		for (int f = begin; f < frame; f ++)
+		{
+			for (int i = 0; i < classes.size (); i ++)
+			{
+				if (!classes.merged (i))
+					continue;
+				int a = frame_id (aig, f, 2 * classes.var (i)), b = repr_id (aig, classes, i, f);
+				solver.add_clause (flag, -a, b);
+				solver.add_clause (flag, a, -b);
+			}
+		}
+		
+		for (int i = 0; i < classes.size (); i ++)
+		{
+			if (!classes.merged (i))
+				continue;
+			int a = frame_id (aig, frame, 2 * classes.var (i)), b = repr_id (aig, classes, i, frame);
+			for (int k = 0; k < 2; k ++)
+			{
+				solver.clear_assumption ();
+				solver.assumption_push (-flag);
+				for (int f = 0; f < frame; f ++)
+					solver.assumption_push (constraint_flag (aig, f));
+				solver.assumption_push (k == 0 ? a : -a);
+				solver.assumption_push (k == 0 ? -b : b);
+				int res = solver.solve_assumption (LATCH_EQ_CONFLICTS);
+				if (res == 0)
+					continue;
+				if (res == -1)
+					classes.isolate (i);
+				else
+				{
+					vector<int> model = solver.get_model ();
+					vector<uint64_t> vals (classes.size ());
+					for (int j = 0; j < classes.size (); j ++)
+					{
+						int id = frame_id (aig, frame, 2 * classes.var (j));
+						vals[j] = (model[id - 1] > 0) ^ classes.phase (j);
+					}
+					bool split = classes.refine (vals);
+					assert (split);
+				}
+				return false;
+			}
+		}
+		return true;
+	}
+	
+	aiger* merge_latches (aiger* aig, const bool verbose)
+	{
+		LatchClasses classes (aig);
+		
+		//sequential simulation from the initial state, 64 patterns
+		vector<uint64_t> vals ((aig->maxvar + 1), 0), nexts (aig->num_latches);
+		for (unsigned i = 0; i < aig->num_latches; i ++)
+			vals[aig->latches[i].lit >> 1] = (aig->latches[i].reset == 1) ? ~uint64_t (0) : 0;
+		uint64_t rng = 0x9E3779B97F4A7C15ULL;
+		vector<uint64_t> cand (classes.size ());
+		uint64_t valid = ~uint64_t (0);
+		for (int c = 0; c < LATCH_EQ_CYCLES; c ++)
+		{
+			for (unsigned i = 0; i < aig->num_latches; i ++)
+			{
+				//random initial values for those without a reset value
+				if (c == 0 && aig->latches[i].reset > 1)
+					vals[aig->latches[i].lit >> 1] = rng = rng * 6364136223846793005ULL + 1442695040888963407ULL;
+			}
+			for (unsigned i = 1; i <= aig->num_inputs; i ++)
+			{
+				rng ^= rng >> 12;
+				rng ^= rng << 25;
+				rng ^= rng >> 27;
+				vals[i] = rng * 2685821657736338717ULL;
+			}
+			for (unsigned i = 0; i < aig->num_ands; i ++)
+			{
+				aiger_and& aa = aig->ands[i];
+				uint64_t v0 = vals[aa.rhs0 >> 1] ^ ((aa.rhs0 & 1) ? ~uint64_t (0) : 0);
+				uint64_t v1 = vals[aa.rhs1 >> 1] ^ ((aa.rhs1 & 1) ? ~uint64_t (0) : 0);
+				vals[aa.lhs >> 1] = v0 & v1;
+			}
+			//only the patterns meeting the constraints in the previous cycles tell reachable states
+			for (int j = 0; j < classes.size (); j ++)
+				cand[j] = (vals[classes.var (j)] ^ (classes.phase (j) ? ~uint64_t (0) : 0)) & valid;
+			classes.refine (cand);
+			for (unsigned i = 0; i < aig->num_constraints; i ++)
+				valid &= vals[aig->constraints[i].lit >> 1] ^ ((aig->constraints[i].lit & 1) ? ~uint64_t (0) : 0);
+			for (unsigned i = 0; i < aig->num_latches; i ++)
+			{
+				unsigned next = aig->latches[i].next;
+				nexts[i] = vals[next >> 1] ^ ((next & 1) ? ~uint64_t (0) : 0);
+			}
+			for (unsigned i = 0; i < aig->num_latches; i ++)
+				vals[aig->latches[i].lit >> 1] = nexts[i];
+		}
+		
+		//the candidates hold in copy 0 from the reset values, and in copies 1 ... k-1 by BMC,
+		//then by k-induction. Any split makes both checked again.
+		int flag = constraint_flag (aig, LATCH_EQ_DEPTH);
+		CARSolver base;
+		unroll (base, aig, LATCH_EQ_DEPTH);
+		for (int j = 1; j < classes.size (); j ++)
+			base.add_clause (frame_id (aig, 0, 2 * classes.var (j) + (classes.phase (j) ^ 1)));
+		//no initial state meets the constraints, so no path is valid
+		base.clear_assumption ();
+		base.assumption_push (constraint_flag (aig, 0));
+		if (base.solve_assumption (LATCH_EQ_CONFLICTS) == 0)
+		{
+			if (verbose)
+				cout << "merge latches: the constraints fail in every initial state" << endl;
+			AigBuilder builder (aig, true);
+			builder.set_no_path ();
+			for (unsigned i = 0; i < aig->num_ands; i ++)
+			{
+				aiger_and& aa = aig->ands[i];
+				builder.set (aa.lhs >> 1, builder.add_and (builder.lit (aa.rhs0), builder.lit (aa.rhs1)));
+			}
+			return builder.finish ();
+		}
+		CARSolver step;
+		unroll (step, aig, LATCH_EQ_DEPTH + 1);
+		bool done = false;
+		while (!done)
+		{
+			done = true;
+			for (int f = 1; f < LATCH_EQ_DEPTH && done; f ++)
+				done = check_frame (base, aig, classes, f, f, flag);
+			if (done)
+				done = check_frame (step, aig, classes, 0, LATCH_EQ_DEPTH, flag);
+		}
+		
+		//the merged latches take the literals of their representatives
+		vector<char> removed (aig->num_latches, 0);
+		int num_merged = 0, num_constant = 0;
+		unsigned first_latch = aig->num_inputs + 1;
+		for (int j = 1; j < classes.size (); j ++)
+		{
+			if (!classes.merged (j))
+				continue;
+			removed[classes.var (j) - first_latch] = 1;
+			num_merged ++;
+			if (classes.repr (j) == 0)
+				num_constant ++;
+		}
+		AigBuilder builder (aig, true, &removed);
+		for (int j = 1; j < classes.size (); j ++)
+		{
+			if (classes.merged (j))
+			{
+				int r = classes.repr (j);
+				builder.set (classes.var (j), builder.lit (2 * classes.var (r) + (classes.phase (j) ^ classes.phase (r))));
+			}
+		}
+		for (unsigned i = 0; i < aig->num_ands; i ++)
+		{
+			aiger_and& aa = aig->ands[i];
+			builder.set (aa.lhs >> 1, builder.add_and (builder.lit (aa.rhs0), builder.lit (aa.rhs1)));
+		}
+		
+		if (verbose)
+			cout << "merge latches: " << num_merged << " of " << aig->num_latches << " latches merged, " << num_constant << " of them constant" << endl;
+		return builder.finish ();
+	}
+	
+	aiger* slice (aiger* aig, const unsigned output)
+	{
+		unsigned first_latch = aig->num_inputs + 1, first_and = first_latch + aig->num_latches;
+		vector<char> in_coi (aig->maxvar + 1, 0);
+		vector<unsigned> stack;
+		stack.push_back (aig->outputs[output].lit >> 1);
+		for (unsigned i = 0; i < aig->num_constraints; i ++)
+			stack.push_back (aig->constraints[i].lit >> 1);
+		while (!stack.empty ())
+		{
+			unsigned v = stack.back ();
+			stack.pop_back ();
+			if (v == 0 || in_coi[v])
+				continue;
+			in_coi[v] = 1;
+			if (v >= first_and)
+			{
+				aiger_and* aa = aiger_is_and (aig, 2 * v);
+				stack.push_back (aa->rhs0 >> 1);
+				stack.push_back (aa->rhs1 >> 1);
+			}
+			else if (v >= first_latch)
+				stack.push_back (aig->latches[v - first_latch].next >> 1);
+		}
+		
+		vector<char> removed (aig->num_latches);
+		for (unsigned i = 0; i < aig->num_latches; i ++)
+			removed[i] = !in_coi[first_latch + i];
+		AigBuilder builder (aig, false, &removed);
+		for (unsigned i = 0; i < aig->num_ands; i ++)
+		{
+			aiger_and& aa = aig->ands[i];
+			if (in_coi[aa.lhs >> 1])
+				builder.set (aa.lhs >> 1, builder.add_and (builder.lit (aa.rhs0), builder.lit (aa.rhs1)));
+		}
+		return builder.finish (output);
+	}
+	
+	string reset_line (aiger* aig)
+	{
+		string res;
+		for (unsigned i = 0; i < aig->num_latches; i ++)
+		{
+			unsigned reset = aig->latches[i].reset;
+			res += (reset == 0) ? "0" : ((reset == 1) ? "1" : "x");
+		}
+		return res;
+	}
+	
+	aiger* rebuild (aiger* aig, const vector<unsigned>& repr)
+	{
+		AigBuilder builder (aig, false);
+		for (unsigned i = 0; i < aig->num_ands; i ++)
+		{
+			aiger_and& aa = aig->ands[i];
+			unsigned v = aa.lhs >> 1;
+			if (repr[v] != 2 * v)
+			{
+				assert ((repr[v] >> 1) < v);
+				builder.set (v, builder.lit (repr[v]));
+			}
+			else
+				builder.set (v, builder.add_and (builder.lit (aa.rhs0), builder.lit (aa.rhs1)));
+		}
+		return builder.finish ();
+	}
+}
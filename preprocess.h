@@ -0,0 +1,108 @@
+/*
+    Copyright (C) 2018, Jianwen Li (lijwen2748@gmail.com), Iowa State University
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+	Author: Jianwen Li
+	Update Date: October 19, 2026
+	Preprocessing of the aiger model before it is encoded by Model
+*/
+
+#ifndef PREPROCESS_H
+#define PREPROCESS_H
+
+extern "C" {
+#include "aiger.h"
+}
+#include <vector>
+#include <map>
+#include <string>
+
+#define FRAIG_WORDS 4          //64-bit words of the simulation signatures
+#define FRAIG_CONFLICTS 100    //conflict budget of each equivalence check
+#define FRAIG_MAX_CALLS 20000  //budget of equivalence checks in total
+
+#define LATCH_EQ_CYCLES 32        //cycles of the simulation proposing latch equivalences
+#define LATCH_EQ_DEPTH 1          //k of the k-induction proving them
+#define LATCH_EQ_CONFLICTS 1000   //conflict budget of each check
+
+namespace car
+{
+	//The passes return a new reencoded aiger, and the caller resets the old one.
+	//Inputs and latches are kept in their order, so witnesses hold for both.
+	
+	//SAT sweeping: merge the and gates proved to be equivalent (up to complement) to an earlier gate or a constant
+	aiger* fraig (aiger* aig, const bool verbose = false);
+	
+	//structural hashing, constant propagation including the latches stuck at their reset values,
+	//then balancing of the and trees to reduce the depth
+	aiger* optimize (aiger* aig, const bool verbose = false);
+	
+	//Latches equivalent to another latch or a constant (up to complement) in all reachable states are
+	//proposed by simulation from the initial state, proved by k-induction, and replaced by the literal
+	//of their representatives. Witnesses need the initial values of the old aiger for the latches.
+	aiger* merge_latches (aiger* aig, const bool verbose = false);
+	
+	//the cone of influence of output \@ output and the constraints: all the inputs, and the latches and gates it reads,
+	//with \@ output as the only output
+	aiger* slice (aiger* aig, const unsigned output);
+	//the initial values of the latches as in the witness
+	std::string reset_line (aiger* aig);
+	
+	//Copy \@ aig with each and gate var replaced by the literal of the old aiger in \@ repr,
+	//which must be an earlier variable or the gate itself.
+	aiger* rebuild (aiger* aig, const std::vector<unsigned>& repr);
+	
+	//Builds the new aiger of a pass over \@ aig: the inputs and latches keep their order and come first,
+	//then the and gates added in topological order, and finish () adds the latch nexts and the properties.
+	class AigBuilder
+	{
+	public:
+		//with \@ strash, and gates are simplified over constants and equal literals and hashed structurally,
+		//and the latches marked in \@ removed (by their indices) are left out, to be set () by the caller
+		AigBuilder (aiger* aig, const bool strash = true, const std::vector<char>* removed = NULL);
+		~AigBuilder () {if (res_ != NULL) aiger_reset (res_);}
+		
+		//the new literal of the old literal \@ old
+		inline unsigned lit (const unsigned old) {return lits_[old >> 1] ^ (old & 1);}
+		//let the old variable \@ var be the new literal \@ l
+		inline void set (const unsigned var, const unsigned l) {lits_[var] = l;}
+		inline int level (const unsigned l) {return levels_[l >> 1];}
+		
+		unsigned add_and (unsigned a, unsigned b);
+		//no path meets the constraints, so finish () makes the properties FALSE
+		inline void set_no_path () {no_path_ = true;}
+		//only output \@ output is kept if it is not -1
+		aiger* finish (const int output = -1);
+		
+	private:
+		aiger* aig_;
+		aiger* res_;
+		bool strash_;
+		bool no_path_;
+		std::vector<unsigned> latch_lits_;     //the literals of the kept latches in res_, 0 for the removed ones
+		std::vector<unsigned> lits_;           //the new literals of the old variables
+		std::vector<int> levels_;              //the levels of the new variables
+		std::map<std::pair<unsigned, unsigned>, unsigned> table_;  //structural hashing
+		
+		inline unsigned new_var () {
+			levels_.push_back (0);
+			return 2 * (levels_.size () - 1);
+		}
+	};
+}
+
+#endif
@@ -38,8 +38,15 @@ namespace car {
                 add_cube (const_cast<Model*>(m)->init ());
             else
             {
+                //only bad is assumed, so the gates are encoded in the polarities it needs
+                std::vector<char> pol;
+                const_cast<Model*>(m)->polarities (std::vector<int> (1, bad), false, pol);
+                ClauseArena& cls = const_cast<Model*>(m)->clauses ();
                 for (int i = 0; i < const_cast<Model*>(m)->latches_start (); i ++)
-                    add_clause (const_cast<Model*>(m)->element (i));
+                {
+                    if (const_cast<Model*>(m)->needed (i, pol))
+                        add_clause (cls.clause (i), cls.clause_size (i));
+                }
                 assumption_push (bad);
             }
             
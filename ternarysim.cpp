@@ -0,0 +1,162 @@
+/*
+    Copyright (C) 2018, Jianwen Li (lijwen2748@gmail.com), Iowa State University
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+	Author: Jianwen Li
+	Update Date: October 19, 2026
+	Ternary (0/1/X) simulation over the and gates of the model
+*/
+
+#include "ternarysim.h"
+#include <algorithm>
+#include <assert.h>
+using namespace std;
+
+namespace car
+{
+	TernarySim::TernarySim (Model* m)
+	{
+		model_ = m;
+		values_.resize (m->max_id () + 1, X);
+		values_[m->true_id ()] = ONE;
+		values_[m->false_id ()] = ZERO;
+		gate_of_.resize (m->max_id () + 1, -1);
+		fanouts_.resize (m->max_id () + 1);
+		queued_.resize (m->gates ().size (), false);
+
+		vector<Gate>& gates = m->gates ();
+		for (int i = 0; i < gates.size (); i ++)
+		{
+			gate_of_[gates[i].lhs] = i;
+			fanouts_[abs (gates[i].rhs0)].push_back (i);
+			if (abs (gates[i].rhs1) != abs (gates[i].rhs0))
+				fanouts_[abs (gates[i].rhs1)].push_back (i);
+		}
+	}
+
+	void TernarySim::set_state (const Assignment& st)
+	{
+		int end = model_->num_inputs () + model_->num_latches ();
+		for (int i = 1; i <= end; i ++)
+			values_[i] = X;
+		for (int i = 0; i < st.size (); i ++)
+			values_[abs (st[i])] = (st[i] > 0) ? ONE : ZERO;
+	}
+
+	void TernarySim::simulate ()
+	{
+		vector<Gate>& gates = model_->gates ();
+		for (int i = 0; i < gates.size (); i ++)
+			values_[gates[i].lhs] = eval (gates[i]);
+	}
+
+	void TernarySim::change (const int id, const char v)
+	{
+		trail_.push_back (pair<int, char> (id, values_[id]));
+		values_[id] = v;
+
+		vector<int>& fo = fanouts_[id];
+		for (int i = 0; i < fo.size (); i ++)
+		{
+			if (!queued_[fo[i]])
+			{
+				queued_[fo[i]] = true;
+				queue_.push (fo[i]);
+			}
+		}
+
+		vector<Gate>& gates = model_->gates ();
+		while (!queue_.empty ())
+		{
+			int g = queue_.top ();
+			queue_.pop ();
+			queued_[g] = false;
+			char nv = eval (gates[g]);
+			int lhs = gates[g].lhs;
+			if (nv == values_[lhs])
+				continue;
+			trail_.push_back (pair<int, char> (lhs, values_[lhs]));
+			values_[lhs] = nv;
+			vector<int>& fo2 = fanouts_[lhs];
+			for (int i = 0; i < fo2.size (); i ++)
+			{
+				if (!queued_[fo2[i]])
+				{
+					queued_[fo2[i]] = true;
+					queue_.push (fo2[i]);
+				}
+			}
+		}
+	}
+
+	void TernarySim::backtrack ()
+	{
+		for (int i = trail_.size () - 1; i >= 0; i --)
+			values_[trail_[i].first] = trail_[i].second;
+		trail_.clear ();
+	}
+
+	bool TernarySim::lift (Assignment& st, const vector<int>& targets)
+	{
+		set_state (st);
+		simulate ();
+		for (int i = 0; i < targets.size (); i ++)
+		{
+			if (value (targets[i]) != ONE)
+				return false;
+		}
+
+		Assignment res;
+		for (int i = 0; i < st.size (); i ++)
+		{
+			int id = st[i];
+			if (!model_->latch_var (abs (id)))
+			{
+				res.push_back (id);
+				continue;
+			}
+			change (abs (id), X);
+			bool kept = true;
+			for (int j = 0; j < targets.size (); j ++)
+			{
+				if (value (targets[j]) != ONE)
+				{
+					kept = false;
+					break;
+				}
+			}
+			if (kept)
+				trail_.clear ();
+			else
+			{
+				backtrack ();
+				res.push_back (id);
+			}
+		}
+		st = res;
+		return true;
+	}
+
+	char TernarySim::value_with_x (const vector<int>& vars, const int id)
+	{
+		for (int i = 0; i < vars.size (); i ++)
+			change (vars[i], X);
+		char res = value (id);
+		backtrack ();
+		return res;
+	}
+}
@@ -0,0 +1,87 @@
+/*
+    Copyright (C) 2018, Jianwen Li (lijwen2748@gmail.com), Iowa State University
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+	Author: Jianwen Li
+	Update Date: October 19, 2026
+	Ternary (0/1/X) simulation over the and gates of the model
+*/
+
+#ifndef TERNARY_SIM_H
+#define TERNARY_SIM_H
+
+#include "model.h"
+#include "data_structure.h"
+#include <vector>
+#include <queue>
+#include <functional>
+
+namespace car
+{
+	class TernarySim
+	{
+	public:
+		enum {ZERO = 0, ONE = 1, X = 2};
+
+		TernarySim (Model* m);
+		~TernarySim () {}
+
+		//assign the inputs and latches in \@ st, all the others are X
+		void set_state (const Assignment& st);
+		void simulate ();
+
+		inline char value (const int id) {
+			char v = values_[abs (id)];
+			if (v == X || id > 0)
+				return v;
+			return ONE - v;
+		}
+
+		//Given a full assignment \@ st of inputs and latches, set latches to X one by one and keep X if
+		//all literals in \@ targets are still true. The inputs and the remaining latches are left in \@ st.
+		//Return false, with \@ st unchanged, if \@ targets are not all true under \@ st.
+		bool lift (Assignment& st, const std::vector<int>& targets);
+		
+		//the value of \@ id when the variables in \@ vars are set to X, which are restored afterwards
+		char value_with_x (const std::vector<int>& vars, const int id);
+
+	private:
+		Model* model_;
+		std::vector<char> values_;     //indexed by the model ids
+		std::vector<int> gate_of_;     //index of the gate defining a variable, -1 if none
+		std::vector<std::vector<int> > fanouts_;  //gates reading a variable
+
+		std::priority_queue<int, std::vector<int>, std::greater<int> > queue_;  //gates to evaluate, in topological order
+		std::vector<bool> queued_;
+		std::vector<std::pair<int, char> > trail_;  //old values of the changed variables
+
+		inline char eval (const Gate& g) {
+			char v0 = value (g.rhs0), v1 = value (g.rhs1);
+			if (v0 == ZERO || v1 == ZERO)
+				return ZERO;
+			if (v0 == ONE && v1 == ONE)
+				return ONE;
+			return X;
+		}
+
+		//change the value of \@ id and evaluate its fanouts incrementally
+		void change (const int id, const char v);
+		void backtrack ();
+	};
+}
+
+#endif